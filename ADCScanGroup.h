@@ -0,0 +1,173 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADCSCANGROUP_H
+#define ADCSCANGROUP_H
+
+#include <stdint.h>
+
+/*
+ * Scan group ADC sampling for STM32F4, enabled by defining STM32_ADC_SCAN_GROUP
+ * in config.h.
+ *
+ * Instead of starting one conversion per interrupt and cycling through the
+ * analogue inputs in use, all the channels in use are put into the regular
+ * sequence of the ADC and converted in one pass, with the results transferred
+ * to a buffer by DMA.  Each call to poll() from the waveform interrupt checks
+ * whether the pass is complete and, if it is, copies the results to the value
+ * cache and starts the next pass.  So every input is read once per pass rather
+ * than once every so many interrupts, and the interrupt handler doesn't have to
+ * look for the next input to read.
+ *
+ * The ADC and DMA stream register blocks are template parameters, so the
+ * sequencing can be run on a host against mock structures with the same member
+ * names as the CMSIS ADC_TypeDef and DMA_Stream_TypeDef.
+ *
+ * Register bits are those of the STM32F4 reference manuals (RM0383, RM0390).
+ */
+
+template <typename ADCRegs, typename DMAStreamRegs>
+class ADCScanGroup {
+public:
+  // dmaFlagClear is the interrupt flag clear register of the DMA controller
+  // (LIFCR or HIFCR) and dmaFlagMask the flags of the stream in it.
+  ADCScanGroup(ADCRegs *adc, DMAStreamRegs *dma, uint8_t dmaChannel,
+      volatile uint32_t *dmaFlagClear, uint32_t dmaFlagMask) {
+    _adc = adc;
+    _dma = dma;
+    _dmaChannel = dmaChannel;
+    _dmaFlagClear = dmaFlagClear;
+    _dmaFlagMask = dmaFlagMask;
+  }
+
+  // Add a channel to the sequence, with the id under which its value is kept.
+  // Call with the group stopped.  Returns false if the sequence is full.
+  bool add(uint8_t id, uint8_t channel) {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_ids[i] == id) {
+        _channels[i] = channel;
+        return true;
+      }
+    }
+    if (_count >= MAX_CHANNELS) return false;
+    _ids[_count] = id;
+    _channels[_count] = channel;
+    _count++;
+    return true;
+  }
+
+  // Load the sequence into the ADC, set up the DMA stream and start the first pass.
+  void start() {
+    if (_count == 0) return;
+    uint32_t sqr[3] = {0, 0, 0};  // SQR3, SQR2, SQR1
+    for (uint8_t i = 0; i < _count; i++)
+      sqr[i / 6] |= (uint32_t)_channels[i] << ((i % 6) * 5);
+    _adc->SQR3 = sqr[0];
+    _adc->SQR2 = sqr[1];
+    _adc->SQR1 = sqr[2] | ((uint32_t)(_count - 1) << 20);  // L = conversions - 1
+    _adc->CR1 |= ADC_SCAN;
+    _adc->CR2 &= ~(ADC_CONT | ADC_DDS);
+    _adc->CR2 |= ADC_EOCS;  // EOC after each conversion, so that overruns are flagged
+    _dma->CR = 0;
+    while (_dma->CR & DMA_EN) {}  // Wait for the stream to stop
+    _dma->PAR = (uintptr_t)&_adc->DR;
+    _dma->M0AR = (uintptr_t)_results;
+    // Peripheral to memory, 16 bit transfers, memory increment, high priority
+    _dma->CR = ((uint32_t)_dmaChannel << 25) | (2UL << 16) | (1UL << 13) | (1UL << 11) | DMA_MINC;
+    _running = true;
+    startPass();
+  }
+
+  // Wait for the pass in progress to finish and put the ADC back to single
+  // conversions of SQR3, e.g. for ADCee::init().
+  void stop() {
+    if (!_running) return;
+    for (uint16_t i = 0; i < 10000 && _dma->NDTR != 0 && !(_adc->SR & ADC_OVR); i++) {}
+    _dma->CR &= ~DMA_EN;
+    _adc->CR2 &= ~(ADC_DMA | ADC_DDS | ADC_EOCS);
+    _adc->CR1 &= ~ADC_SCAN;
+    _adc->SQR1 = 0;  // 1 conversion
+    _adc->SR = ~(ADC_OVR | ADC_EOC);  // Status bits are cleared by writing 0
+    _running = false;
+  }
+
+  // Called from the interrupt handler.  If the pass is complete, copy the
+  // results into values[] by id and start the next pass.  Returns true if
+  // new values were copied.
+  bool poll(int *values) {
+    if (!_running) return false;
+    if (_adc->SR & ADC_OVR) {
+      // A conversion was lost (e.g. DMA held up), discard the pass.
+      _adc->SR = ~ADC_OVR;
+      startPass();
+      return false;
+    }
+    if (_dma->NDTR != 0) return false;  // Pass in progress
+    for (uint8_t i = 0; i < _count; i++)
+      values[_ids[i]] = _results[i];
+    startPass();
+    return true;
+  }
+
+  uint8_t count() { return _count; }
+
+private:
+  static const uint8_t MAX_CHANNELS = 16;  // Length of regular sequence
+
+  // ADC_CR1, ADC_CR2 and ADC_SR bits
+  static const uint32_t ADC_SCAN = 1UL << 8;
+  static const uint32_t ADC_CONT = 1UL << 1;
+  static const uint32_t ADC_DMA = 1UL << 8;
+  static const uint32_t ADC_DDS = 1UL << 9;
+  static const uint32_t ADC_EOCS = 1UL << 10;
+  static const uint32_t ADC_SWSTART = 1UL << 30;
+  static const uint32_t ADC_EOC = 1UL << 1;
+  static const uint32_t ADC_OVR = 1UL << 5;
+  // DMA_SxCR bits
+  static const uint32_t DMA_EN = 1UL << 0;
+  static const uint32_t DMA_MINC = 1UL << 10;
+
+  // Rearm the DMA stream and start a conversion of the whole sequence.
+  void startPass() {
+    _dma->CR &= ~DMA_EN;
+    while (_dma->CR & DMA_EN) {}
+    *_dmaFlagClear = _dmaFlagMask;
+    _dma->NDTR = _count;
+    _dma->CR |= DMA_EN;
+    // The ADC stops making DMA requests after the last transfer (DDS=0)
+    // until the DMA bit is cleared and set again.
+    _adc->CR2 &= ~ADC_DMA;
+    _adc->CR2 |= ADC_DMA;
+    _adc->CR2 |= ADC_SWSTART;
+  }
+
+  ADCRegs *_adc;
+  DMAStreamRegs *_dma;
+  volatile uint32_t *_dmaFlagClear;
+  uint32_t _dmaFlagMask;
+  uint8_t _dmaChannel;
+  uint8_t _ids[MAX_CHANNELS];
+  uint8_t _channels[MAX_CHANNELS];
+  volatile uint16_t _results[MAX_CHANNELS];
+  uint8_t _count = 0;
+  bool _running = false;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALOGUESLOTMAP_H
+#define ANALOGUESLOTMAP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Reverse of an analogue pin map, as sent by an EX-IOExpander: the pin map
+ * gives the pin number of each analogue slot (index into the analogue input
+ * states), and this gives the slot of each pin number, so that a read is a
+ * single indexed load instead of a search of the pin map.  The table only
+ * extends as far as the highest analogue pin, to save RAM.
+ *
+ * There are no Arduino dependencies, so that the lookup can be checked and
+ * timed on a host (see tests/exio_analogue_bench.cpp).
+ */
+
+class AnalogueSlotMap {
+public:
+  static const uint8_t NONE = 0xFF;
+
+  // (Re)build the table from the pin map.  The table is only reallocated if it
+  // has to grow.  Returns false if allocation fails, leaving the table empty.
+  bool build(const uint8_t *pinMap, uint8_t numPins) {
+    uint8_t highestPin = 0;
+    for (uint8_t aPin = 0; aPin < numPins; aPin++)
+      if (pinMap[aPin] > highestPin) highestPin = pinMap[aPin];
+    if (_count < (uint16_t)highestPin + 1) {
+      if (_count > 0) free(_slots);
+      _slots = (uint8_t *)malloc(highestPin + 1);
+      if (_slots == NULL) {
+        _count = 0;
+        return false;
+      }
+      _count = highestPin + 1;
+    }
+    memset(_slots, NONE, _count);
+    for (uint8_t aPin = 0; aPin < numPins; aPin++)
+      _slots[pinMap[aPin]] = aPin;
+    return true;
+  }
+
+  // Analogue slot of a pin, or NONE if it isn't an analogue pin.
+  uint8_t slot(unsigned int pin) const {
+    if (pin >= _count) return NONE;
+    return _slots[pin];
+  }
+
+private:
+  uint8_t *_slots = NULL;
+  uint16_t _count = 0;  // Size of allocated _slots
+};
+
+#endif
@@ -268,3 +268,7 @@ void CommandDistributor::broadcastRaw(clientType type, char * msg) {
 void CommandDistributor::broadcastTrackState(const FSH* format,byte trackLetter,int16_t dcAddr) {
   broadcastReply(COMMAND_TYPE, format,trackLetter,dcAddr);
 }
+
+void CommandDistributor::broadcastCurrentTrace(char trackLetter, uint16_t time, const char *hex) {
+  broadcastReply(COMMAND_TYPE, F("<jS %c %u %s>\n"), trackLetter, time, hex);
+}
@@ -55,6 +55,7 @@ public :
   static void broadcastPower();
   static void broadcastRaw(clientType type,char * msg);
   static void broadcastTrackState(const FSH* format,byte trackLetter,int16_t dcAddr);
+  static void broadcastCurrentTrace(char trackLetter, uint16_t time, const char *hex);
   template<typename... Targs> static void broadcastReply(clientType type, Targs... msg);
   static void forget(byte clientId);
   
@@ -169,12 +169,25 @@ void loop()
 
   Sensor::checkAll(); // Update and print changes
 
-  // Report any decrease in memory (will automatically trigger on first call)
+#ifndef DISABLE_EEPROM
+  EEStore::loop(); // Write turnout/output state changes in the background
+#endif
+
+  // Report any decrease in memory (will automatically trigger on first call).
+  // While memory is being allocated, e.g. at startup, the reports are limited
+  // to one a second so that a series of decreases is reported once.
   static int ramLowWatermark = __INT_MAX__; // replaced on first loop
+  static bool ramReportPending = false;
+  static unsigned long ramReportTime = 0;
 
   int freeNow = DCCTimer::getMinimumFreeMemory();
   if (freeNow < ramLowWatermark) {
     ramLowWatermark = freeNow;
+    ramReportPending = true;
+  }
+  if (ramReportPending && millis() - ramReportTime >= 1000) {
     LCD(3,F("Free RAM=%5db"), ramLowWatermark);
+    ramReportPending = false;
+    ramReportTime = millis();
   }
 }
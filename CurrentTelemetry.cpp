@@ -0,0 +1,129 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CurrentTelemetry.h"
+
+#if defined(HAS_ENOUGH_MEMORY)
+
+#include "CommandDistributor.h"
+
+CurrentTelemetry::Recorder *CurrentTelemetry::_recorders[TrackManager::MAX_TRACKS];
+
+bool CurrentTelemetry::start(byte track, uint16_t windowMs, uint16_t intervalMs) {
+  if (track >= TrackManager::MAX_TRACKS || TrackManager::track[track] == NULL) return false;
+  if (windowMs == 0 || intervalMs < windowMs) return false;
+  Recorder *r = _recorders[track];
+  if (!r) {
+    r = (Recorder *)calloc(1, sizeof(Recorder));
+    if (!r) return false;
+  }
+  r->windowMs = windowMs;
+  r->intervalMs = intervalMs;
+  r->windowStart = r->lastFrameTime = millis();
+  r->windowMin = 0xffff;
+  r->windowMax = 0;
+  r->windowSum = 0;
+  r->windowCount = 0;
+  r->first = r->count = 0;
+  _recorders[track] = r;
+  return true;
+}
+
+void CurrentTelemetry::stop(byte track) {
+  if (track >= TrackManager::MAX_TRACKS) return;
+  free(_recorders[track]);
+  _recorders[track] = NULL;
+}
+
+void CurrentTelemetry::loop() {
+  unsigned long currentMillis = millis();
+  for (byte t = 0; t < TrackManager::MAX_TRACKS; t++) {
+    Recorder *r = _recorders[t];
+    if (!r) continue;
+    MotorDriver *driver = TrackManager::track[t];
+    sample(driver, r, currentMillis);
+    if (currentMillis - r->lastFrameTime >= r->intervalMs) {
+      sendFrames(t, driver, r);
+      r->lastFrameTime = currentMillis;
+    }
+  }
+}
+
+// Add a reading to the current window, first closing the window if its time is up.
+void CurrentTelemetry::sample(MotorDriver *driver, Recorder *r, unsigned long currentMillis) {
+  if (currentMillis - r->windowStart >= r->windowMs) {
+    if (r->windowCount > 0) {
+      // Add record to ring buffer, overwriting the oldest if it's full.
+      uint8_t pos = r->first + r->count;
+      if (pos >= RECORDS) pos -= RECORDS;
+      if (r->count < RECORDS)
+        r->count++;
+      else if (++r->first >= RECORDS)
+        r->first = 0;
+      Record *rec = &r->records[pos];
+      rec->time = r->windowStart;
+      rec->min = r->windowMin;
+      rec->max = r->windowMax;
+      rec->mean = r->windowSum / r->windowCount;
+    }
+    // Start next window.  If a whole window has been missed, start afresh.
+    if (currentMillis - r->windowStart >= 2UL * r->windowMs)
+      r->windowStart = currentMillis;
+    else
+      r->windowStart += r->windowMs;
+    r->windowMin = 0xffff;
+    r->windowMax = 0;
+    r->windowSum = 0;
+    r->windowCount = 0;
+  }
+  int raw = driver->getCurrentRaw();
+  if (raw < 0) raw = -raw;  // Fault pin active, just record the current
+  if ((uint16_t)raw < r->windowMin) r->windowMin = raw;
+  if ((uint16_t)raw > r->windowMax) r->windowMax = raw;
+  r->windowSum += raw;
+  r->windowCount++;
+}
+
+// Send the records in the ring buffer, up to RECORDS_PER_FRAME consecutive windows per frame.
+void CurrentTelemetry::sendFrames(byte track, MotorDriver *driver, Recorder *r) {
+  static const char hexDigits[] = "0123456789ABCDEF";
+  char hex[RECORDS_PER_FRAME * 12 + 1];
+  while (r->count > 0) {
+    uint16_t frameTime = r->records[r->first].time;
+    uint8_t n = 0;
+    char *ptr = hex;
+    while (r->count > 0 && n < RECORDS_PER_FRAME) {
+      Record *rec = &r->records[r->first];
+      if (rec->time != (uint16_t)(frameTime + n * r->windowMs)) break;  // Gap, start new frame
+      uint16_t values[3] = { (uint16_t)driver->raw2mA(rec->min), (uint16_t)driver->raw2mA(rec->max),
+        (uint16_t)driver->raw2mA(rec->mean) };
+      for (uint8_t i = 0; i < 3; i++)
+        for (int8_t shift = 12; shift >= 0; shift -= 4)
+          *ptr++ = hexDigits[(values[i] >> shift) & 0xf];
+      if (++r->first >= RECORDS) r->first = 0;
+      r->count--;
+      n++;
+    }
+    *ptr = '\0';
+    CommandDistributor::broadcastCurrentTrace('A' + track, frameTime, hex);
+  }
+}
+
+#endif
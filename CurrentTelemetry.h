@@ -0,0 +1,96 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CURRENTTELEMETRY_H
+#define CURRENTTELEMETRY_H
+
+#include <Arduino.h>
+#include "defines.h"
+#include "TrackManager.h"
+
+/*
+ * Current telemetry - a trace of the current drawn on a track, for looking at
+ * inrush currents, short circuits and ack pulses without an oscilloscope.
+ *
+ * While a track is being traced, its current is read on every entry to loop()
+ * and the readings are reduced to the minimum, maximum and mean over windows
+ * of a fixed number of milliseconds.  The window records are kept in a ring
+ * buffer and sent to the command clients at a set interval as compact frames:
+ *
+ *    <jS track time hhhhhhhhhhhh...>
+ *
+ * where time is the start of the first window in the frame (the low 16 bits
+ * of millis()), followed by 12 hex digits per window: the minimum, maximum
+ * and mean current in mA, 4 digits each.  The windows in a frame are
+ * consecutive; if any windows are lost (e.g. because the loop was held up),
+ * a new frame is started.  If the clients can't keep up, the oldest records
+ * are overwritten.
+ *
+ *    <D CURRENT track window interval>  Start tracing, e.g. <D CURRENT A 5 100>
+ *    <D CURRENT track OFF>              Stop tracing
+ *
+ * The memory for a trace is allocated when it is started and released when it
+ * is stopped.
+ */
+
+#if defined(HAS_ENOUGH_MEMORY)
+
+class CurrentTelemetry {
+public:
+  // Start tracing the track, with the window length and the interval between
+  // sending frames in milliseconds.  Returns false if the parameters are
+  // invalid or there's not enough memory.
+  static bool start(byte track, uint16_t windowMs, uint16_t intervalMs);
+  static void stop(byte track);
+  static void loop();
+
+private:
+  static const uint8_t RECORDS = 32;  // Records kept per track
+  static const uint8_t RECORDS_PER_FRAME = 3;  // Fits the broadcast buffer
+
+  struct Record {
+    uint16_t time;  // Start of window, milliseconds
+    uint16_t min;
+    uint16_t max;
+    uint16_t mean;
+  };
+  struct Recorder {
+    uint16_t windowMs;
+    uint16_t intervalMs;
+    unsigned long windowStart;
+    unsigned long lastFrameTime;
+    // Readings in the current window
+    uint16_t windowMin;
+    uint16_t windowMax;
+    uint32_t windowSum;
+    uint16_t windowCount;
+    // Ring buffer of window records
+    uint8_t first;
+    uint8_t count;
+    Record records[RECORDS];
+  };
+  static Recorder *_recorders[TrackManager::MAX_TRACKS];
+
+  static void sample(MotorDriver *driver, Recorder *r, unsigned long currentMillis);
+  static void sendFrames(byte track, MotorDriver *driver, Recorder *r);
+};
+
+#endif
+#endif
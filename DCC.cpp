@@ -56,6 +56,7 @@ const byte FN_GROUP_2=0x02;
 const byte FN_GROUP_3=0x04;
 const byte FN_GROUP_4=0x08;
 const byte FN_GROUP_5=0x10;
+const byte LOCO_STATE_CHANGED=0x80; // in groupFlags: direction or functions changed since last saved
 
 FSH* DCC::shieldName=NULL;
 byte DCC::globalSpeedsteps=128;
@@ -234,7 +235,7 @@ void DCC::updateGroupflags(byte & flags, int16_t functionNumber) {
   else if (functionNumber<=12) groupMask=FN_GROUP_3;
   else if (functionNumber<=20) groupMask=FN_GROUP_4;
   else                         groupMask=FN_GROUP_5;
-  flags |= groupMask;
+  flags |= groupMask | LOCO_STATE_CHANGED;
 }
 
 uint32_t DCC::getFunctionMap(int cab) {
@@ -579,18 +580,61 @@ void DCC::forgetLoco(int cab) {  // removes any speed reminders for this loco
   if (reg>=0) {
     speedTable[reg].loco=0;
     setThrottle2(cab,1); // ESTOP if this loco still on track
+#ifdef SAVE_LOCO_STATES
+    EEStore::forgetLocoState(cab);
+#endif
   }
 }
 void DCC::forgetAllLocos() {  // removes all speed reminders
   setThrottle2(0,1); // ESTOP all locos still on track
   for (int i=0;i<MAX_LOCOS;i++) speedTable[i].loco=0;
+#ifdef SAVE_LOCO_STATES
+  EEStore::forgetLocoState(0);
+#endif
+}
+
+// Put a loco saved before the last restart back in the reminder table, stopped.
+void DCC::restoreLoco(int cab, bool forward, unsigned long functions) {
+  int reg=lookupSpeedTable(cab);
+  if (reg<0) return;
+  speedTable[reg].speedCode = forward ? 128 : 0;
+  speedTable[reg].functions = functions;
+  // Send all function groups which have a function on.
+  byte flags=0;
+  for (int16_t functionNumber=0; functionNumber<=28; functionNumber++)
+    if (functions & (1UL<<functionNumber)) updateGroupflags(flags, functionNumber);
+  speedTable[reg].groupFlags = flags & ~LOCO_STATE_CHANGED;  // already saved
+}
+
+#ifdef SAVE_LOCO_STATES
+// Save the state of one changed loco, no more often than once per second, and
+// only when the EEStore has room to queue it.  It is then written in the 
+// background.
+void DCC::saveLocoStates() {
+  static unsigned long lastSaveTime=0;
+  static int reg=0;
+  unsigned long currentTime=millis();
+  if (currentTime - lastSaveTime < 1000) return;
+  lastSaveTime=currentTime;
+  for (int count=0; count<=highestUsedReg; count++) {
+    if (++reg > highestUsedReg) reg=0;
+    if (speedTable[reg].loco > 0 && (speedTable[reg].groupFlags & LOCO_STATE_CHANGED)) {
+      if (EEStore::saveLocoState(speedTable[reg].loco, speedTable[reg].speedCode & 0x80, speedTable[reg].functions))
+        speedTable[reg].groupFlags &= ~LOCO_STATE_CHANGED;
+      return;
+    }
+  }
 }
+#endif
 
 byte DCC::loopStatus=0;
 
 void DCC::loop()  {
   TrackManager::loop(); // power overload checks
   issueReminders();
+#ifdef SAVE_LOCO_STATES
+  saveLocoStates();
+#endif
 }
 
 void DCC::issueReminders() {
@@ -681,7 +725,7 @@ int DCC::lookupSpeedTable(int locoId, bool autoCreate) {
   if (reg==firstEmpty){
         speedTable[reg].loco = locoId;
         speedTable[reg].speedCode=128;  // default direction forward
-        speedTable[reg].groupFlags=0;
+        speedTable[reg].groupFlags=LOCO_STATE_CHANGED;
         speedTable[reg].functions=0;
   }
   if (reg > highestUsedReg) highestUsedReg = reg;
@@ -706,6 +750,8 @@ void  DCC::updateLocoReminder(int loco, byte speedCode) {
   // determine speed reg for this loco
   int reg=lookupSpeedTable(loco);
   if (reg>=0 && speedTable[reg].speedCode!=speedCode) {
+    if ((speedTable[reg].speedCode ^ speedCode) & 0x80)
+      speedTable[reg].groupFlags |= LOCO_STATE_CHANGED;  // direction change
     speedTable[reg].speedCode = speedCode;
     CommandDistributor::broadcastLoco(reg);
   }
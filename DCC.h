@@ -87,6 +87,7 @@ public:
   // Enhanced API functions
   static void forgetLoco(int cab); // removes any speed reminders for this loco
   static void forgetAllLocos();    // removes all speed reminders
+  static void restoreLoco(int cab, bool forward, unsigned long functions); // loco state saved before restart
   static void displayCabList(Print *stream);
   static FSH *getMotorShieldName();
   static inline void setGlobalSpeedsteps(byte s) {
@@ -111,6 +112,9 @@ private:
   static void updateLocoReminder(int loco, byte speedCode);
   static void setFunctionInternal(int cab, byte fByte, byte eByte);
   static bool issueReminder(int reg);
+#ifdef SAVE_LOCO_STATES
+  static void saveLocoStates();
+#endif
   static int lastLocoReminder;
   static int highestUsedReg;
   static FSH *shieldName;
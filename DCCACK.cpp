@@ -48,6 +48,8 @@ bool   DCCACK::ackManagerRejoin;
 volatile uint8_t DCCACK::numAckGaps=0;
 volatile uint8_t DCCACK::numAckSamples=0;
 uint8_t DCCACK::trailingEdgeCounter=0;
+DCCACK::PhaseStats DCCACK::phaseStats[PHASE_COUNT];
+byte DCCACK::ackPhaseMask=(1<<PHASE_COUNT)-1;
 
 
  unsigned int DCCACK::ackPulseDuration;  // micros
@@ -140,6 +142,7 @@ void DCCACK::setAckPending() {
       ackDetected=false;
       ackCheckStart=millis();
       numAckSamples=0;
+      memset(phaseStats, 0, sizeof(phaseStats));
       numAckGaps=0;
       ackPending=true;  // interrupt routines will now take note
 }
@@ -148,10 +151,24 @@ byte DCCACK::getAck() {
       if (ackPending) return (2);  // still waiting
       if (Diag::ACK) DIAG(F("%S after %dmS max=%d/%dmA pulse=%uuS samples=%d gaps=%d"),ackDetected?F("ACK"):F("NO-ACK"), ackCheckDuration,
 			  ackMaxCurrent,progDriver->raw2mA(ackMaxCurrent), ackPulseDuration, numAckSamples, numAckGaps);
+      if (Diag::ACK) reportPhaseStats();
       if (ackDetected) return (1); // Yes we had an ack
       return(0);  // pending set off but not detected means no ACK.   
 }
 
+void DCCACK::reportPhaseStats() {
+  for (byte phase=0; phase<PHASE_COUNT; phase++) {
+    PhaseStats *stats=&phaseStats[phase];
+    if (stats->samples==0) continue;
+    const FSH *name= phase==PHASE_PREAMBLE ? F("PREAMBLE") : phase==PHASE_PACKET ? F("PACKET")
+                   : phase==PHASE_IDLE ? F("IDLE") : F("UNKNOWN");
+    int mean=stats->sum/stats->samples;
+    DIAG(F("ACK phase %S samples=%d mean=%dmA max=%dmA%S"), name, stats->samples,
+	 progDriver->raw2mA(mean), progDriver->raw2mA(stats->max),
+	 (ackPhaseMask & (1<<phase)) ? F("") : F(" ignored"));
+  }
+}
+
 #ifndef DISABLE_PROG
 void DCCACK::loop() {
   while (ackManagerProg) {
@@ -416,7 +433,7 @@ void DCCACK::callback(int value) {
 }
 #endif
 
-void DCCACK::checkAck(byte sentResetsSincePacket) {
+void DCCACK::checkAck(byte sentResetsSincePacket, WAVE_PHASE phase) {
     if (!ackPending) return; 
     // This function operates in interrupt() time so must be fast and can't DIAG 
     if (sentResetsSincePacket > 6) {  //ACK timeout
@@ -427,6 +444,12 @@ void DCCACK::checkAck(byte sentResetsSincePacket) {
       
     int current=progDriver->getCurrentRaw(true); // true means "from interrupt"
     numAckSamples++;
+    PhaseStats *stats=&phaseStats[phase];
+    stats->samples++;
+    stats->sum+=current;
+    if (current > stats->max) stats->max=current;
+    // Samples in phases not selected by <D ACK PHASE mask> are only counted
+    if (!(ackPhaseMask & (1<<phase))) return;
     if (current > ackMaxCurrent) ackMaxCurrent=current;
     // An ACK is a pulse lasting between minAckPulseDuration and maxAckPulseDuration uSecs (refer @haba)
         
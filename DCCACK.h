@@ -25,6 +25,7 @@
 #define DCCACK_h
 
 #include "MotorDriver.h"
+#include "DCCWaveform.h"
 
 typedef void (*ACK_CALLBACK)(int16_t result);
 
@@ -73,7 +74,7 @@ enum   CALLBACK_STATE : byte {
 class DCCACK {
   public:
     static byte getAck();               //prog track only 0=NACK, 1=ACK 2=keep waiting
-    static void checkAck(byte sentResetsSincePacket); // Interrupt time ack checker
+    static void checkAck(byte sentResetsSincePacket, WAVE_PHASE phase=PHASE_UNKNOWN); // Interrupt time ack checker
     static inline void setAckLimit(int mA) {
 	ackLimitmA = mA;
     }
@@ -83,6 +84,14 @@ class DCCACK {
     static inline void setMaxAckPulseDuration(unsigned int i) {
 	maxAckPulseDuration = i;
     }
+    // Phases of the waveform (bit mask of 1<<WAVE_PHASE) whose current samples
+    // are used to detect acks.  Samples in all phases are counted in the stats.
+    // Samples whose phase isn't known (e.g. on ESP32) are always used, otherwise
+    // acks could never be detected there.  Returns the mask in use.
+    static inline byte setAckPhases(byte mask) {
+	ackPhaseMask = mask | (1<<PHASE_UNKNOWN);
+	return ackPhaseMask;
+    }
 
     static void  Setup(int cv, byte byteValueOrBitnum, ackOp const program[], ACK_CALLBACK callback);
     static void  Setup(int wordval, ackOp const program[], ACK_CALLBACK callback);
@@ -133,6 +142,15 @@ class DCCACK {
     static volatile uint8_t numAckGaps;
     static volatile uint8_t numAckSamples;
     static uint8_t trailingEdgeCounter;
+    // Current samples during the ack check, by waveform phase
+    struct PhaseStats {
+      uint16_t samples;
+      int max;
+      int32_t sum;
+    };
+    static PhaseStats phaseStats[PHASE_COUNT];
+    static byte ackPhaseMask;
+    static void reportPhaseStats();
     static ackOp  const *  ackManagerProg;
 static ackOp  const *  ackManagerProgStart;
 static byte   ackManagerByte;
@@ -46,6 +46,7 @@
 #include "Turnouts.h"
 #include "Sensors.h"
 #include "Outputs.h"
+#include "EEStore.h"
 #include "CommandDistributor.h"
 #include "TrackManager.h"
 #include "DCCTimer.h"    
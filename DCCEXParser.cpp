@@ -114,6 +114,8 @@ Once a new OPCODE is decided upon, update this list.
 #include "TrackManager.h"
 #include "DCCTimer.h"
 #include "EXRAIL2.h"
+#include "MemoryStats.h"
+#include "CurrentTelemetry.h"
 
 // This macro can't be created easily as a portable function because the
 // flashlist requires a far pointer for high flash access. 
@@ -130,6 +132,16 @@ Once a new OPCODE is decided upon, update this list.
 const int16_t HASH_KEYWORD_MAIN = 11339;
 const int16_t HASH_KEYWORD_CABS = -11981;
 const int16_t HASH_KEYWORD_RAM = 25982;
+#ifdef STATIC_MEMORY_POOLS
+const int16_t HASH_KEYWORD_POOLS = -31953;
+#endif
+#ifdef MEMORY_STATS
+const int16_t HASH_KEYWORD_MEM = 16101;
+#endif
+#ifdef HAS_ENOUGH_MEMORY
+const int16_t HASH_KEYWORD_CURRENT = 11433;
+const int16_t HASH_KEYWORD_OFF = 22479;
+#endif
 const int16_t HASH_KEYWORD_CMD = 9962;
 const int16_t HASH_KEYWORD_ACK = 3113;
 const int16_t HASH_KEYWORD_ON = 2657;
@@ -148,6 +160,8 @@ const int16_t HASH_KEYWORD_MAX = 16244;
 const int16_t HASH_KEYWORD_MIN = 15978;
 const int16_t HASH_KEYWORD_RESET = 26133;
 const int16_t HASH_KEYWORD_RETRY = 25704;
+const int16_t HASH_KEYWORD_PHASE = -721;
+const int16_t HASH_KEYWORD_TRIP = -17217;
 const int16_t HASH_KEYWORD_SPEED28 = -17064;
 const int16_t HASH_KEYWORD_SPEED128 = 25816;
 const int16_t HASH_KEYWORD_SERVO=27709;
@@ -949,6 +963,12 @@ bool DCCEXParser::parseS(Print *stream, int16_t params, int16_t p[])
 
     switch (params)
     {
+    case 4: // <S id pin pullup debounce>  create sensor with debounce time in ms.
+        if (p[3] < 0 || !Sensor::create(p[0], p[1], p[2], p[3]))
+          return false;
+        StringFormatter::send(stream, F("<O>\n"));
+        return true;
+
     case 3: // <S id pin pullup>  create sensor. pullUp indicator (0=LOW/1=HIGH)
         if (!Sensor::create(p[0], p[1], p[2]))
           return false;
@@ -962,13 +982,7 @@ bool DCCEXParser::parseS(Print *stream, int16_t params, int16_t p[])
         return true;
 
     case 0: // <S> list sensor definitions
-      if (Sensor::firstSensor == NULL)
-        return false;
-      for (Sensor *tt = Sensor::firstSensor; tt != NULL; tt = tt->nextSensor)
-      {
-          StringFormatter::send(stream, F("<Q %d %d %d>\n"), tt->data.snum, tt->data.pin, tt->data.pullUp);
-      }
-      return true;
+      return Sensor::printDefinitions(stream);
 
     default: // invalid number of arguments
         break;
@@ -991,8 +1005,20 @@ bool DCCEXParser::parseD(Print *stream, int16_t params, int16_t p[])
         StringFormatter::send(stream, F("Free memory=%d\n"), DCCTimer::getMinimumFreeMemory());
         return true;
 
+#ifdef STATIC_MEMORY_POOLS
+    case HASH_KEYWORD_POOLS: // <D POOLS>
+        MemoryPool::printAll();
+        return true;
+#endif
+
+#ifdef MEMORY_STATS
+    case HASH_KEYWORD_MEM: // <D MEM>
+        MemoryStats::printAll();
+        return true;
+#endif
+
 #ifndef DISABLE_PROG
-    case HASH_KEYWORD_ACK: // <D ACK ON/OFF> <D ACK [LIMIT|MIN|MAX|RETRY] Value>
+    case HASH_KEYWORD_ACK: // <D ACK ON/OFF> <D ACK [LIMIT|MIN|MAX|RETRY|PHASE] Value>
 	if (params >= 3) {
 	    if (p[1] == HASH_KEYWORD_LIMIT) {
 	      DCCACK::setAckLimit(p[2]);
@@ -1006,6 +1032,8 @@ bool DCCEXParser::parseD(Print *stream, int16_t params, int16_t p[])
 	    } else if (p[1] == HASH_KEYWORD_RETRY) {
 	      if (p[2] >255) p[2]=3;
 	      LCD(0, F("Ack Retry=%d Sum=%d"), p[2], DCCACK::setAckRetry(p[2]));  //   <D ACK RETRY 2>
+	    } else if (p[1] == HASH_KEYWORD_PHASE) {
+	      LCD(0, F("Ack Phases=%d"), DCCACK::setAckPhases(p[2]));  //   <D ACK PHASE 3>
 	    }
 	} else {
 	  StringFormatter::send(stream, F("Ack diag %S\n"), onOff ? F("on") : F("off"));
@@ -1018,7 +1046,20 @@ bool DCCEXParser::parseD(Print *stream, int16_t params, int16_t p[])
         Diag::CMD = onOff;
         return true;
 
+    case HASH_KEYWORD_TRIP: // <D TRIP track [curveMs hardPercent filterShift]>
+        if (params < 2) return false;
+        return TrackManager::setTripCurve(p[1] - HASH_KEYWORD_A, params - 2, p + 2);
+
 #ifdef HAS_ENOUGH_MEMORY
+    case HASH_KEYWORD_CURRENT: // <D CURRENT track window interval> <D CURRENT track OFF>
+        if (params == 3 && p[2] == HASH_KEYWORD_OFF) {
+            CurrentTelemetry::stop(p[1] - HASH_KEYWORD_A);
+            return true;
+        }
+        if (params >= 3)
+            return CurrentTelemetry::start(p[1] - HASH_KEYWORD_A, p[2], params > 3 ? p[3] : 100);
+        return false;
+
     case HASH_KEYWORD_WIFI: // <D WIFI ON/OFF>
         Diag::WIFI = onOff;
         return true;
@@ -1049,6 +1090,8 @@ bool DCCEXParser::parseD(Print *stream, int16_t params, int16_t p[])
     case HASH_KEYWORD_EEPROM: // <D EEPROM NumEntries>
 	if (params >= 2)
 	    EEStore::dump(p[1]);
+	else
+	    EEStore::printStats(); // <D EEPROM>
 	return true;
 #endif
 
@@ -82,6 +82,10 @@ class DCCTimer {
   };
 
   static int  getMinimumFreeMemory();
+  // Heap memory allocated (including the allocator's overheads), and the 
+  // largest block that can be allocated now.
+  static long heapInUse();
+  static long largestFreeBlock();
   static void reset();
   
 private:
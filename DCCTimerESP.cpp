@@ -73,6 +73,18 @@ int DCCTimer::getMinimumFreeMemory() {
 int DCCTimer::freeMemory() {
   return ESP.getFreeHeap();
 }
+
+// The heap runs from the end of the static data (_heap_start, from the linker
+// script) to 0x3FFFC000, as in the umm_malloc configuration of the core.
+extern "C" char _heap_start[];
+
+long DCCTimer::heapInUse() {
+  return (long)(0x3FFFC000UL - (uint32_t)_heap_start) - (long)ESP.getFreeHeap();
+}
+
+long DCCTimer::largestFreeBlock() {
+  return ESP.getMaxFreeBlockSize();
+}
 #endif
 
 ////////////////////////////////////////////////////////////////////////
@@ -152,6 +164,14 @@ int DCCTimer::freeMemory() {
   return ESP.getFreeHeap();
 }
 
+long DCCTimer::heapInUse() {
+  return ESP.getHeapSize() - ESP.getFreeHeap();
+}
+
+long DCCTimer::largestFreeBlock() {
+  return ESP.getMaxAllocHeap();
+}
+
 void DCCTimer::reset() {
    ESP.restart();
 }
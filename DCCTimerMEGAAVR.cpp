@@ -119,6 +119,30 @@ int DCCTimer::freeMemory() {
   return __brkval ? &top - __brkval : &top - __malloc_heap_start;
 }
 
+// The free list of avr-libc's malloc (see stdlib_private.h), which is not 
+// otherwise accessible.
+struct __freelist {
+  size_t sz;
+  struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+long DCCTimer::heapInUse() {
+  long used = (__brkval ? __brkval : __malloc_heap_start) - __malloc_heap_start;
+  for (struct __freelist *fp = __flp; fp; fp = fp->nx)
+    used -= fp->sz + sizeof(size_t);
+  return used;
+}
+
+long DCCTimer::largestFreeBlock() {
+  // Either a block on the free list, or the space between the heap and the stack 
+  // less the margin that malloc keeps for the stack.
+  long largest = freeMemory() - (long)__malloc_margin;
+  for (struct __freelist *fp = __flp; fp; fp = fp->nx)
+    if ((long)fp->sz > largest) largest = fp->sz;
+  return largest < 0 ? 0 : largest;
+}
+
 void DCCTimer::reset() {
   CPU_CCP=0xD8;
   WDT.CTRLA=0x4;
@@ -113,6 +113,14 @@ int DCCTimer::freeMemory() {
   return rp2040.getFreeHeap();
 }
 
+long DCCTimer::heapInUse() {
+  return rp2040.getUsedHeap();
+}
+
+long DCCTimer::largestFreeBlock() {
+  return freeMemory();  // Total free heap, which may be fragmented
+}
+
 void DCCTimer::reset() {
    rp2040.reboot();
 }
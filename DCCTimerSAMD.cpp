@@ -29,6 +29,7 @@
 #ifdef ARDUINO_ARCH_SAMD
 
 #include "DCCTimer.h"
+#include <malloc.h>
 #include <wiring_private.h>
 
 INTERRUPT_CALLBACK interruptHandler=0;
@@ -150,6 +151,14 @@ int DCCTimer::freeMemory() {
   return (int)(&top - reinterpret_cast<char *>(sbrk(0)));
 }
 
+long DCCTimer::heapInUse() {
+  return mallinfo().uordblks;
+}
+
+long DCCTimer::largestFreeBlock() {
+  return freeMemory();  // Space above the heap; freed blocks may be larger
+}
+
 void DCCTimer::reset() {
    __disable_irq();
     NVIC_SystemReset();
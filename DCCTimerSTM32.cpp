@@ -30,6 +30,7 @@
 #ifdef ARDUINO_ARCH_STM32
 
 #include "DCCTimer.h"
+#include <malloc.h>
 #ifdef DEBUG_ADC
 #include "TrackManager.h"
 #endif
@@ -229,6 +230,14 @@ int DCCTimer::freeMemory() {
   return (int)(&top - reinterpret_cast<char *>(sbrk(0)));
 }
 
+long DCCTimer::heapInUse() {
+  return mallinfo().uordblks;
+}
+
+long DCCTimer::largestFreeBlock() {
+  return freeMemory();  // Space above the heap; freed blocks may be larger
+}
+
 void DCCTimer::reset() {
    __disable_irq();
     NVIC_SystemReset();
@@ -248,6 +257,11 @@ uint8_t ADCee::highestPin = 0;
 int * ADCee::analogvals = NULL;
 uint32_t * analogchans = NULL;
 bool adc1configured = false;
+#ifdef STM32_ADC_SCAN_GROUP
+#include "ADCScanGroup.h"
+// ADC1 is served by DMA2 stream 0 channel 0; the stream's flags are bits 0-5 of LIFCR.
+static ADCScanGroup<ADC_TypeDef, DMA_Stream_TypeDef> scanGroup(ADC1, DMA2_Stream0, 0, &DMA2->LIFCR, 0x3DUL);
+#endif
 
 int16_t ADCee::ADCmax() {
   return 4095;
@@ -297,17 +311,23 @@ int ADCee::init(uint8_t pin) {
   else
     ADC1->SMPR1 |= (0b111 << ((adcchan - 10) * 3)); // Channel sampling rate 480 cycles
 
+  uint8_t id = pin - PNUM_ANALOG_BASE;
+  if (id > 15) { // today we have not enough bits in the mask to support more
+    return -1021;
+  }
+
+#ifdef STM32_ADC_SCAN_GROUP
+  // The scan group may already be running, so stop it for the initial read
+  // and restart it with this channel added.
+  noInterrupts();
+  scanGroup.stop();
+#endif
   // Read the inital ADC value for this analog input
   ADC1->SQR3 = adcchan;           // 1st conversion in regular sequence
   ADC1->CR2 |= (1 << 30);         // Start 1st conversion SWSTART
   while(!(ADC1->SR & (1 << 1)));  // Wait until conversion is complete
   value = ADC1->DR;               // Read value from register
 
-  uint8_t id = pin - PNUM_ANALOG_BASE;
-  if (id > 15) { // today we have not enough bits in the mask to support more
-    return -1021;
-  }
-
   if (analogvals == NULL) {  // allocate analogvals and analogchans if this is the first invocation of init.
     analogvals = (int *)calloc(NUM_ADC_INPUTS+1, sizeof(int));
     analogchans = (uint32_t *)calloc(NUM_ADC_INPUTS+1, sizeof(uint32_t));
@@ -316,6 +336,11 @@ int ADCee::init(uint8_t pin) {
   analogchans[id] = adcchan;  // Keep track of which ADC channel is used for reading this pin
   usedpins |= (1 << id);      // This pin is now ready
   if (id > highestPin) highestPin = id; // Store our highest pin in use
+#ifdef STM32_ADC_SCAN_GROUP
+  scanGroup.add(id, adcchan);
+  scanGroup.start();
+  interrupts();
+#endif
 
   DIAG(F("ADCee::init(): value=%d, channel=%d, id=%d"), value, adcchan, id);
 
@@ -340,6 +365,12 @@ int ADCee::read(uint8_t pin, bool fromISR) {
  */
 #pragma GCC push_options
 #pragma GCC optimize ("-O3")
+#ifdef STM32_ADC_SCAN_GROUP
+void ADCee::scan() {
+  // All pins are converted in one pass, see ADCScanGroup.h
+  scanGroup.poll(analogvals);
+}
+#else
 void ADCee::scan() {
   static uint8_t id = 0;     // id and mask are the same thing but it is faster to
   static uint16_t mask = 1;  // increment and shift instead to calculate mask from id
@@ -387,6 +418,7 @@ void ADCee::scan() {
     }
   }
 }
+#endif
 #pragma GCC pop_options
 
 void ADCee::begin() {
@@ -405,6 +437,9 @@ void ADCee::begin() {
   ADC1->SQR2 &= ~(0x3FFFFFFF); //Clear whole 1st 30bits in register
   ADC1->SQR3 &= ~(0x3FFFFFFF); //Clear whole 1st 30bits in register
   ADC1->CR2 |= (1 << 0); // Switch on ADC1
+#ifdef STM32_ADC_SCAN_GROUP
+  RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN; // Enable DMA2 clock for the scan group
+#endif
   interrupts();
 }
 #endif
@@ -29,6 +29,7 @@
 #ifdef TEENSYDUINO
 
 #include "DCCTimer.h"
+#include <malloc.h>
 
 INTERRUPT_CALLBACK interruptHandler=0;
 
@@ -136,6 +137,20 @@ int DCCTimer::freeMemory() {
 }
 
 #endif
+
+long DCCTimer::heapInUse() {
+  return mallinfo().uordblks;
+}
+
+long DCCTimer::largestFreeBlock() {
+  // Space above the heap; freed blocks may be larger
+#if defined(__IMXRT1062__)
+  extern unsigned long _heap_end;  // Heap is in OCRAM, not with the stack
+  return (char *)&_heap_end - reinterpret_cast<char *>(sbrk(0));
+#else
+  return freeMemory();
+#endif
+}
 void DCCTimer::reset() {
   // found at https://forum.pjrc.com/threads/59935-Reboot-Teensy-programmatically
   SCB_AIRCR = 0x05FA0004;
@@ -91,7 +91,7 @@ void DCCWaveform::interruptHandler() {
   // WAVE_PENDING means we dont yet know what the next bit is
   if (mainTrack.state==WAVE_PENDING) mainTrack.interrupt2();  
   if (progTrack.state==WAVE_PENDING) progTrack.interrupt2();
-  else DCCACK::checkAck(progTrack.getResets());
+  else DCCACK::checkAck(progTrack.getResets(), progTrack.getPhase());
 
 }
 #pragma GCC pop_options
@@ -107,6 +107,7 @@ DCCWaveform::DCCWaveform( byte preambleBits, bool isMain) {
   isMainTrack = isMain;
   packetPending = false;
   memcpy(transmitPacket, idlePacket, sizeof(idlePacket));
+  transmitIdle = true;
   state = WAVE_START;
   // The +1 below is to allow the preamble generator to create the stop bit
   // for the previous packet. 
@@ -162,6 +163,7 @@ void DCCWaveform::interrupt2() {
         transmitLength = pendingLength;
         transmitRepeats = pendingRepeats;
         packetPending = false;
+        transmitIdle = false;
         clearResets();
       }
       else {
@@ -169,6 +171,7 @@ void DCCWaveform::interrupt2() {
         memcpy( transmitPacket, isMainTrack ? idlePacket : resetPacket, sizeof(idlePacket));
         transmitLength = sizeof(idlePacket);
         transmitRepeats = 0;
+        transmitIdle = true;
         if (getResets() < 250) sentResetsSincePacket++; // only place to increment (private!)
       }
     }
@@ -42,6 +42,11 @@ const byte   MAX_PACKET_SIZE = 5;  // NMRA standard extended packets, payload si
 // to the transform array.
 enum  WAVE_STATE : byte {WAVE_START=0,WAVE_MID_1=1,WAVE_HIGH_0=2,WAVE_MID_0=3,WAVE_LOW_0=4,WAVE_PENDING=5};
 
+// Part of the DCC stream being sent, for tagging current samples (see DCCACK::checkAck).
+// PHASE_IDLE is idle packets on main or reset packets on prog. PHASE_UNKNOWN is used
+// where the waveform is not generated bit by bit (ESP32).
+enum  WAVE_PHASE : byte {PHASE_PREAMBLE=0,PHASE_PACKET=1,PHASE_IDLE=2,PHASE_UNKNOWN=3,PHASE_COUNT=4};
+
 // NOTE: static functions are used for the overall controller, then
 // one instance is created for each track.
 
@@ -56,6 +61,11 @@ class DCCWaveform {
 #ifndef ARDUINO_ARCH_ESP32
     inline void clearResets() { sentResetsSincePacket=0; }
     inline byte getResets() { return sentResetsSincePacket; }
+    // Phase of the bit being sent (the last preamble bit counts as packet)
+    inline WAVE_PHASE getPhase() {
+      if (remainingPreambles > 0) return PHASE_PREAMBLE;
+      return transmitIdle ? PHASE_IDLE : PHASE_PACKET;
+    }
 #else
   // extrafudge is added when we know that the resets will first come extrafudge  packets in the future
     inline void clearResets(byte extrafudge=0) {
@@ -82,6 +92,7 @@ class DCCWaveform {
 #ifndef ARDUINO_ARCH_ESP32
     volatile bool packetPending;
     volatile byte sentResetsSincePacket;
+    bool transmitIdle;  // transmitPacket is an idle or reset packet
 #else
     volatile uint32_t resetPacketBase;
 #endif
@@ -29,8 +29,13 @@
  *  4) If there are fewer non-blank rows than screen lines,
  *     then a scrolling strategy is adopted so that, on each screen
  *     refresh, a different subset of the rows is presented.
- *  5) On each entry into loop2(), a single operation is sent to the 
- *     screen; this may be a position command or a character for
+ *  5) A copy is kept of the characters on the screen, and only the
+ *     characters that have changed are sent.  Each run of changed
+ *     characters is sent as a position command followed by the
+ *     characters, which the device may write in one transmission.
+ *     If nothing has changed, nothing is sent.
+ *  6) On each entry into loop2(), a single operation is sent to the 
+ *     screen; this may be a position command or a run of characters for
  *     display.  This spreads the onerous work of updating the screen
  *     and ensures that other loop() functions in the application are
  *     not held up significantly.  The exception to this is when 
@@ -46,6 +51,7 @@
  */
 
 #include "Display.h"
+#include "I2CManager.h"
 
 // Constructor - allocates device driver.
 Display::Display(DisplayDevice *deviceDriver) {
@@ -53,6 +59,8 @@ Display::Display(DisplayDevice *deviceDriver) {
   // Get device dimensions in characters (e.g. 16x2).
   numScreenColumns = _deviceDriver->getNumCols();
   numScreenRows = _deviceDriver->getNumRows();
+  if (numScreenRows > MAX_CHARACTER_ROWS) numScreenRows = MAX_CHARACTER_ROWS;
+  clearScreenCopy();
   for (uint8_t row = 0; row < MAX_CHARACTER_ROWS; row++) 
     rowBuffer[row][0] = '\0';
   
@@ -62,10 +70,13 @@ Display::Display(DisplayDevice *deviceDriver) {
 void Display::begin() {
   _deviceDriver->begin();
   _deviceDriver->clearNative();
+  clearScreenCopy();
 }
 
 void Display::_clear() {
   _deviceDriver->clearNative();
+  clearScreenCopy();
+  rowsChanged = 0xff;
   for (uint8_t row = 0; row < MAX_CHARACTER_ROWS; row++) 
     rowBuffer[row][0] = '\0';
 }
@@ -73,7 +84,10 @@ void Display::_clear() {
 void Display::_setRow(uint8_t line) {
   hotRow = line;
   hotCol = 0;
-  rowBuffer[hotRow][0] = '\0';  // Clear existing text
+  if (hotRow < MAX_CHARACTER_ROWS) {
+    rowBuffer[hotRow][0] = '\0';  // Clear existing text
+    rowsChanged |= 1 << hotRow;  // Row to be refreshed on the screen
+  }
 }
 
 size_t Display::_write(uint8_t b) {
@@ -84,6 +98,10 @@ size_t Display::_write(uint8_t b) {
   return 1;
 }
 
+uint8_t Display::_getSubBusKey() {
+  return subBusKey(_deviceDriver->getI2CAddress());
+}
+
 // Refresh screen completely (will block until complete). Used
 // during start-up.
 void Display::_refresh() {
@@ -101,101 +119,141 @@ void Display::_displayLoop() {
 Display *Display::loop2(bool force) {
   unsigned long currentMillis = millis();
 
-  if (!force) {
-    // See if we're in the time between updates
-    if ((currentMillis - lastScrollTime) < DISPLAY_SCROLL_TIME)
-      return NULL;
-  } else {
+  if (force) {
     // force full screen update from the beginning.
     rowFirst = 0;
     rowCurrent = 0;
-    bufferPointer = 0;
-    noMoreRowsToDisplay = false;
+    updating = false;
+  }
+  if (!updating) {
+    // See if we're in the time between updates.  The screen moves on to the next 
+    // page every DISPLAY_SCROLL_TIME.  In between, changes to the rows are shown 
+    // on the current page, but not more often than every DISPLAY_UPDATE_TIME, so
+    // that a burst of changes to a row results in one screen update.
+    if (force || (currentMillis - lastScrollTime) >= DISPLAY_SCROLL_TIME) {
+      // Choose the rows for the next page.
+      pageFirst = rowFirst;
+      pageCurrent = rowCurrent;
+      lastScrollTime = currentMillis;
+    } else if (rowsChanged && (currentMillis - lastUpdateTime) >= DISPLAY_UPDATE_TIME) {
+      // Choose the rows for the current page again, in case rows have 
+      // become blank or non-blank.
+      rowFirst = pageFirst;
+      rowCurrent = pageCurrent;
+    } else
+      return NULL;
+    selectRows();
+    rowsChanged = 0;
+    lastUpdateTime = currentMillis;
+    // Start comparing at the top left.
     slot = 0;
+    charIndex = 0;
+    cursorValid = false;
+    updating = true;
   }
 
-  do {
-    if (bufferPointer == 0) {
-      // Search for non-blank row
-      while (!noMoreRowsToDisplay) {
-        if (!isCurrentRowBlank()) break;
-        moveToNextRow();
-        if (rowCurrent == rowFirst) noMoreRowsToDisplay = true;  
-      }
+  uint8_t width = (numScreenColumns < MAX_CHARACTER_COLS) ? numScreenColumns : MAX_CHARACTER_COLS;
+  while (slot < numScreenRows) {
+    const char *text = (slotRow[slot] == NO_ROW) ? "" : rowBuffer[slotRow[slot]];
+    uint8_t textLength = strlen(text);
+    char *shown = screen[slot];
 
-      if (noMoreRowsToDisplay) {
-        // No non-blank lines left, so draw blank line
-        buffer[0] = '\0';
-      } else {
-        // Non-blank line found, so copy it (including terminator)
-        for (uint8_t i = 0; i <= MAX_CHARACTER_COLS; i++)
-          buffer[i] = rowBuffer[rowCurrent][i];
-      }
-      _deviceDriver->setRowNative(slot);  // Set position for display
+    // Skip over characters that are already on the screen.
+    while (charIndex < width 
+        && (charIndex < textLength ? text[charIndex] : ' ') == shown[charIndex]) {
+      charIndex++;
+      cursorValid = false;
+    }
+    if (charIndex >= width) {
+      // Screen slot up to date, move to next one.
+      slot++;
       charIndex = 0;
-      bufferPointer = &buffer[0];
+      cursorValid = false;
+      continue;
+    }
+
+    if (!cursorValid) {
+      // Position at the start of the changed characters
+      _deviceDriver->setCursorNative(charIndex, slot);
+      cursorValid = true;
     } else {
-      // Write next character, or a space to erase current position.
-      char ch = *bufferPointer;
-      if (ch) {
-        _deviceDriver->writeNative(ch);
-        bufferPointer++;
-      } else {
-        _deviceDriver->writeNative(' ');
+      // Write the changed characters (or spaces to erase them) as one run.
+      char run[MAX_CHARACTER_COLS];
+      uint8_t length = 0;
+      for (uint8_t col = charIndex; col < width; col++) {
+        char ch = (col < textLength) ? text[col] : ' ';
+        if (ch == shown[col]) break;
+        run[length++] = ch;
       }
+      uint8_t written = _deviceDriver->writeNative(run, length);
+      memcpy(&shown[charIndex], run, written);
+      charIndex += written;
+    }
+    if (!force) return NULL;  // One operation per entry
+  }
 
-      if (++charIndex >= MAX_CHARACTER_COLS) {
-        // Screen slot completed, move to next nonblank row
-        bufferPointer = 0;
-        for (;;) {
-          moveToNextRow();
-          if (rowCurrent == rowFirst) {
-            noMoreRowsToDisplay = true;
-            break;
-          }  
-          if (!isCurrentRowBlank()) break;
-        }
-        // Move to next screen slot, if available
-        slot++;
-        if (slot >= numScreenRows) {
-          // Last slot on screen written, so get ready for next screen update.
+  // Screen updated, so get ready for the next update.
+  updating = false;
+  return NULL;
+}
+
+// Choose the text row to be shown in each screen slot, and work out where
+// the next update is to start according to the scroll mode.
+void Display::selectRows() {
+  bool noMoreRowsToDisplay = false;
+  for (uint8_t s = 0; s < numScreenRows; s++) {
+    // Search for non-blank row
+    while (!noMoreRowsToDisplay) {
+      if (!isCurrentRowBlank()) break;
+      moveToNextRow();
+      if (rowCurrent == rowFirst) noMoreRowsToDisplay = true;  
+    }
+    // If there are no non-blank rows left, then the slot is left blank.
+    slotRow[s] = noMoreRowsToDisplay ? NO_ROW : rowCurrent;
+
+    // Move to next nonblank row
+    for (;;) {
+      moveToNextRow();
+      if (rowCurrent == rowFirst) {
+        noMoreRowsToDisplay = true;
+        break;
+      }  
+      if (!isCurrentRowBlank()) break;
+    }
+  }
 #if SCROLLMODE==0
-          // Scrollmode 0 scrolls continuously.  If the rows fit on the screen,
-          // then restart at row 0, but otherwise continue with the row
-          // after the last one displayed.
-          if (countNonBlankRows() <= numScreenRows)
-            rowCurrent = 0;
-          rowFirst = rowCurrent;
+  // Scrollmode 0 scrolls continuously.  If the rows fit on the screen,
+  // then restart at row 0, but otherwise continue with the row
+  // after the last one displayed.
+  if (countNonBlankRows() <= numScreenRows)
+    rowCurrent = 0;
+  rowFirst = rowCurrent;
 #elif SCROLLMODE==1
-          // Scrollmode 1 scrolls by page, so if the last page has just completed then
-          // next time restart with row 0.
-          if (noMoreRowsToDisplay) 
-            rowFirst = rowCurrent = 0;
+  // Scrollmode 1 scrolls by page, so if the last page has just completed then
+  // next time restart with row 0.
+  if (noMoreRowsToDisplay) 
+    rowFirst = rowCurrent = 0;
 #else
-          // Scrollmode 2 scrolls by row.  If the rows don't fit on the screen,
-          // then start one row further on next time.  If they do fit, then 
-          // show them in order and start next page at row 0.
-          if (countNonBlankRows() <= numScreenRows) {
-            rowFirst = rowCurrent = 0;
-          } else {
-            // Find first non-blank row after the previous first row
-            rowCurrent = rowFirst;
-            do {
-              moveToNextRow();
-            } while (isCurrentRowBlank());
-            rowFirst = rowCurrent;
-          }
+  // Scrollmode 2 scrolls by row.  If the rows don't fit on the screen,
+  // then start one row further on next time.  If they do fit, then 
+  // show them in order and start next page at row 0.
+  if (countNonBlankRows() <= numScreenRows) {
+    rowFirst = rowCurrent = 0;
+  } else {
+    // Find first non-blank row after the previous first row
+    rowCurrent = rowFirst;
+    do {
+      moveToNextRow();
+    } while (isCurrentRowBlank());
+    rowFirst = rowCurrent;
+  }
 #endif
-          noMoreRowsToDisplay = false;
-          slot = 0;
-          lastScrollTime = currentMillis;
-          return NULL;
-        }
-      }
-    }
-  } while (force);
+}
 
-  return NULL;
+// Record that the screen is blank, after it has been cleared.
+void Display::clearScreenCopy() {
+  memset(screen, ' ', sizeof(screen));
+  cursorValid = false;
 }
 
 bool Display::isCurrentRowBlank() {
@@ -40,24 +40,34 @@ public:
   static const int MAX_CHARACTER_ROWS = 8;
   static const int MAX_CHARACTER_COLS = MAX_MSG_SIZE;
   static const long DISPLAY_SCROLL_TIME = 3000;  // 3 seconds
+  static const long DISPLAY_UPDATE_TIME = 500;   // Minimum time between updates of changed rows
 
 private:
   DisplayDevice *_deviceDriver;
 
+  static const uint8_t NO_ROW = 0xff;
+
   unsigned long lastScrollTime = 0;
+  unsigned long lastUpdateTime = 0;
   uint8_t hotRow = 0;
   uint8_t hotCol = 0;
   uint8_t slot = 0;
   uint8_t rowFirst = 0;
   uint8_t rowCurrent = 0;
-  uint8_t charIndex = 0;
-  char buffer[MAX_CHARACTER_COLS + 1];
-  char* bufferPointer = 0;
-  bool noMoreRowsToDisplay = false;
+  uint8_t charIndex = 0;    // Next screen column to be compared
+  bool cursorValid = false; // Device cursor is at (charIndex, slot)
+  bool updating = false;    // Screen update in progress
+  uint8_t rowsChanged = 0;  // Bit per text row written since the last update
+  uint8_t pageFirst = 0;    // Values of rowFirst and rowCurrent at the start
+  uint8_t pageCurrent = 0;  //  of the page on the screen
   uint16_t numScreenRows;
   uint16_t numScreenColumns = MAX_CHARACTER_COLS;
 
   char rowBuffer[MAX_CHARACTER_ROWS][MAX_CHARACTER_COLS+1];
+  // Text row shown in each screen slot (or NO_ROW) for the current update
+  uint8_t slotRow[MAX_CHARACTER_ROWS];
+  // Characters currently shown on the screen
+  char screen[MAX_CHARACTER_ROWS][MAX_CHARACTER_COLS];
 
 public:
   void begin() override;  
@@ -66,8 +76,11 @@ public:
   size_t _write(uint8_t b) override;
   void _refresh() override;
   void _displayLoop() override;
+  uint8_t _getSubBusKey() override;
+  bool _isUpdating() override { return updating; }
   Display *loop2(bool force);
-  bool findNonBlankRow();
+  void selectRows();
+  void clearScreenCopy();
   bool isCurrentRowBlank();
   void moveToNextRow();
   uint8_t countNonBlankRows();
@@ -20,8 +20,57 @@
  */
 
 #include "DisplayInterface.h"
+#include "I2CManager.h"
 
 // Install null display driver initially - will be replaced if required.
 DisplayInterface *DisplayInterface::_displayHandler = new DisplayInterface();
 
 uint8_t DisplayInterface::_selectedDisplayNo = 255;
+
+uint8_t DisplayInterface::_activeSubBusKey = DisplayInterface::MAIN_BUS;
+unsigned long DisplayInterface::_groupStartTime = 0;
+
+// Service the displays.  Where displays are attached to I2C mux sub-buses,
+// only the displays on one sub-bus are serviced on each entry, and that 
+// sub-bus stays active while any of its displays has a screen update in 
+// progress.  The writes to the displays on a sub-bus then follow each other,
+// and the I2C manager selects the sub-bus once for them all instead of
+// switching the mux for each write.  When the displays on the sub-bus are
+// up to date (or GROUP_TIME_LIMIT has expired), the next sub-bus with 
+// displays takes its turn.  Displays on the main bus are one group, so if 
+// there's no mux all displays are serviced on every entry, as before.
+void DisplayInterface::loop() {
+  bool updating = false;
+  uint16_t nextKey = 0x100, firstKey = 0x100;
+  for (DisplayInterface *p = _displayHandler; p!=0; p=p->_nextHandler) {
+    uint8_t key = p->_getSubBusKey();
+    if (key == _activeSubBusKey) {
+      p->_displayLoop();
+      if (p->_isUpdating()) updating = true;
+    }
+    // Look for the next sub-bus in order, and the first in case of wrapping round.
+    if (key > _activeSubBusKey && key < nextKey) nextKey = key;
+    if (key < firstKey) firstKey = key;
+  }
+  unsigned long currentMillis = millis();
+  if (!updating || currentMillis - _groupStartTime >= GROUP_TIME_LIMIT) {
+    // Move on to next sub-bus.
+    if (nextKey <= 0xff)
+      _activeSubBusKey = nextKey;
+    else if (firstKey <= 0xff) 
+      _activeSubBusKey = firstKey;
+    _groupStartTime = currentMillis;
+  }
+}
+
+uint8_t DisplayInterface::subBusKey(I2CAddress address) {
+#if defined(I2C_EXTENDED_ADDRESS)
+  I2CMux muxNumber = address.muxNumber();
+  I2CSubBus subBus = address.subBus();
+  if (muxNumber != I2CMux_None && subBus < SubBus_No)
+    return (muxNumber << 3) | subBus;
+#else
+  (void)address;
+#endif
+  return MAIN_BUS;
+}
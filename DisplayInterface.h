@@ -23,6 +23,8 @@
 
 #include <Arduino.h>
 
+struct I2CAddress;  // Defined in I2CManager.h
+
 // Definition of base class for displays.  The base class does nothing.
 class DisplayInterface : public Print {
 protected:
@@ -73,10 +75,14 @@ public:
     for (DisplayInterface *p = _displayHandler; p!=0; p=p->_nextHandler)
       if (displayNo == p->_displayNo) p->_refresh();
   }
-  static void loop() {
-    for (DisplayInterface *p = _displayHandler; p!=0; p=p->_nextHandler) 
-      p->_displayLoop();
-  };
+  static void loop();
+
+  // Key for the I2C mux sub-bus that a display is attached to, used to group
+  // the displays on each sub-bus in loop().  Displays on the main bus have
+  // the key MAIN_BUS.
+  static const uint8_t MAIN_BUS = 0xff;
+  static uint8_t subBusKey(I2CAddress address);
+
   // The following are overridden within the specific device class
   virtual void begin() {};
   virtual size_t _write(uint8_t c) { (void)c; return 0; };
@@ -84,6 +90,15 @@ public:
   virtual void _clear() {}
   virtual void _refresh() {}
   virtual void _displayLoop() {}
+  virtual uint8_t _getSubBusKey() { return MAIN_BUS; }
+  virtual bool _isUpdating() { return false; }  // Screen update in progress
+
+private:
+  static uint8_t _activeSubBusKey;
+  static unsigned long _groupStartTime;
+  // Longest time for which the displays on one sub-bus are serviced while
+  // the displays on other sub-buses are waiting.
+  static const unsigned long GROUP_TIME_LIMIT = 100;  // milliseconds
 };
 
 class DisplayDevice {
@@ -91,8 +106,21 @@ public:
   virtual bool begin() { return true; }
   virtual void clearNative() = 0;
   virtual void setRowNative(uint8_t line) = 0;
+  // Set cursor to a character position within a text line
+  virtual void setCursorNative(uint8_t col, uint8_t line) = 0;
   virtual size_t writeNative(uint8_t c) = 0;
+  // Write a run of characters from the cursor position.  Returns the number of
+  // characters taken from the text, which may be fewer than 'length' if the
+  // device can't accept them all in one operation; the caller writes the rest
+  // on later calls, without repositioning the cursor.  By default, one
+  // character is written per call.
+  virtual uint8_t writeNative(const char *text, uint8_t length) {
+    (void)length;
+    writeNative((uint8_t)text[0]);
+    return 1;
+  }
   virtual bool isBusy() = 0;
+  virtual I2CAddress getI2CAddress() = 0;
   virtual uint16_t getNumRows() = 0;
   virtual uint16_t getNumCols() = 0;
 };
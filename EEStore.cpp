@@ -30,59 +30,372 @@
 #include "Outputs.h"
 #include "Sensors.h"
 #include "Turnouts.h"
+#include "MemoryStats.h"
+#ifdef SAVE_LOCO_STATES
+#include "DCC.h"
+#endif
 
 #if defined(ARDUINO_ARCH_SAMC)
 ExternalEEPROM EEPROM;
 #endif
 
+// True if a byte can be written to EEPROM without waiting for the previous write.
+static inline bool eepromReady() {
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+  return eeprom_is_ready();
+#else
+  return true;
+#endif
+}
+
 void EEStore::init() {
+  MEMORY_SCOPE(OBJECTS);
 #if defined(ARDUINO_ARCH_SAMC)
   EEPROM.begin(0x50);  // Address for Microchip 24-series EEPROM with all three
                        // A pins grounded (0b1010000 = 0x50)
 #endif
 
+  unsigned long startTime = micros();
   eeStore = (EEStore *)calloc(1, sizeof(EEStore));
 
   EEPROM.get(0, eeStore->data);  // get eeStore data
 
-  // check to see that eeStore contains valid DCC++ ID
-  if (strncmp(eeStore->data.id, EESTORE_ID, sizeof(EESTORE_ID)) != 0) {  
-    // if not, create blank eeStore structure (no
+  bool convert = false;
+  reset();          // set memory pointer to first definition
+  bool valid = strncmp(eeStore->data.id, EESTORE_ID, sizeof(EESTORE_ID)) == 0
+      && eeStore->data.journalStart >= sizeof(EEStore) 
+      && eeStore->data.journalStart <= EEPROM.length();
+  // Read the definitions in blocks, so that they are only read once for 
+  // checking and loading.
+  if (valid) setBufferArea(sizeof(EEStore), eeStore->data.journalStart);
+
+  if (strncmp(eeStore->data.id, EESTORE_ID_V1, sizeof(EESTORE_ID_V1)) == 0) {
+    // Previous format, with a shorter header and no journal.  Load the
+    // definitions and write them back in the current format.
+    eeAddress = sizeof(EEStoreDataV1);
+    convert = true;
+  } else if (strncmp(eeStore->data.id, EESTORE_ID, sizeof(EESTORE_ID)) != 0) {
+    // if not initialised, create blank eeStore structure (no
     // turnouts, no sensors) and save it back to EEPROM  
-    strncpy(eeStore->data.id, EESTORE_ID, sizeof(EESTORE_ID)+0);  
+    clear();
+  } else if (!valid || eeStore->data.definitionsCrc != definitionsCrc()) {
+    // Damaged, e.g. by loss of power during <E>.  Load nothing, but leave
+    // the EEPROM alone until the next <E> or <e>, so that it can still be
+    // examined.  There is no journal until then.
+    DIAG(F("EEPROM contents invalid, ignored"));
     eeStore->data.nTurnouts = 0;
     eeStore->data.nSensors = 0;
     eeStore->data.nOutputs = 0;
-    EEPROM.put(0, eeStore->data);
+    eeStore->data.journalStart = EEPROM.length();
+    journalEnd = eeStore->data.journalStart;
+    setBufferArea(0, 0);
+  } else {
+    loadJournal();
   }
 
-  reset();          // set memory pointer to first free EEPROM space
   Turnout::load();  // load turnout definitions
   Sensor::load();   // load sensor definitions
   Output::load();   // load output definitions
+  turnoutStates.clear();
+  outputStates.clear();
+#ifdef SAVE_LOCO_STATES
+  // Restore the locos to the reminder table, before the DCC signal starts.
+  for (uint16_t i = 0; i < locoStates.count(); i++) {
+    uint32_t value = locoStates.valueAt(i);
+    if (value & LOCO_PRESENT) 
+      DCC::restoreLoco(locoStates.idAt(i), value & LOCO_FORWARD, value & 0x1FFFFFFFUL);
+  }
+  locoStates.clear();
+#endif
+  setBufferArea(0, 0);
+
+  if (convert) {
+    store();
+    DIAG(F("EEPROM converted to format %s"), EESTORE_ID);
+  }
+  DIAG(F("EEPROM loaded %d turnouts, %d sensors, %d outputs in %lus"), eeStore->data.nTurnouts,
+    eeStore->data.nSensors, eeStore->data.nOutputs, micros() - startTime);
+}
+
+// Reads within the area from 'start' to 'end' go through the buffer, which is
+// refilled a block at a time.  Reads elsewhere go to EEPROM.
+void EEStore::setBufferArea(int start, int end) {
+  bufferAreaStart = start;
+  bufferAreaEnd = end;
+  bufferSize = 0;
+}
+
+void EEStore::readBytes(int address, uint8_t *bytes, int size) {
+  if (address < bufferStart || address + size > bufferStart + bufferSize) {
+    if (address < bufferAreaStart || address + size > bufferAreaEnd || size > bufferCapacity) {
+      for (int i = 0; i < size; i++) bytes[i] = EEPROM.read(address + i);
+      return;
+    }
+    bufferStart = address;
+    bufferSize = min(bufferAreaEnd - address, (int)bufferCapacity);
+#if defined(ARDUINO_ARCH_SAMC)
+    EEPROM.read(bufferStart, buffer, bufferSize);
+#elif defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+    eeprom_read_block(buffer, (const void *)bufferStart, bufferSize);
+#else
+    for (int i = 0; i < bufferSize; i++) buffer[i] = EEPROM.read(bufferStart + i);
+#endif
+  }
+  memcpy(bytes, &buffer[address - bufferStart], size);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void EEStore::clear() {
+  pendingCount = 0;  // Nothing left to update
   sprintf(eeStore->data.id,
           EESTORE_ID);  // create blank eeStore structure (no turnouts, no
                         // sensors) and save it back to EEPROM
   eeStore->data.nTurnouts = 0;
   eeStore->data.nSensors = 0;
   eeStore->data.nOutputs = 0;
-  EEPROM.put(0, eeStore->data);
+  eeStore->data.journalStart = sizeof(EEStore);
+  eeStore->data.journalGeneration = nextGeneration();
+  eeStore->data.definitionsCrc = definitionsCrc();
+  restartJournal();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// Write all definitions, including the current states.  Bytes which are 
+// unchanged are not rewritten, so saving a layout where little has changed is
+// quick.  The journal is restarted after the definitions.
 
 void EEStore::store() {
+  pendingCount = 0;  // Current states are written with the definitions
+  bytesWritten = 0;
   reset();
   Turnout::store();
   Sensor::store();
   Output::store();
-  EEPROM.put(0, eeStore->data);
-  DIAG(F("EEPROM used: %d/%d bytes"), EEStore::pointer(), EEPROM.length());
+  sprintf(eeStore->data.id, EESTORE_ID);
+  eeStore->data.journalStart = pointer();
+  eeStore->data.journalGeneration = nextGeneration();
+  eeStore->data.definitionsCrc = definitionsCrc();
+  restartJournal();
+  DIAG(F("EEPROM used: %d/%d bytes, %l bytes changed"), EEStore::pointer(), EEPROM.length(), bytesWritten);
+}
+
+// Start an empty journal in the half given by the new generation, abandoning any
+// record or snapshot in progress, and write the header.
+void EEStore::restartJournal() {
+  outBusy = false;
+  compacting = false;
+  justCompacted = false;
+  snapshotNeeded = false;
+  journalEnd = journalHalfStart();
+  if (journalHalfSize() > 0) {
+    const uint8_t invalid = 0xFF;
+    writeBytes(journalEnd, &invalid, 1);
+  }
+  writeHeader();
+}
+
+void EEStore::writeHeader() {
+  writeBytes(0, (const uint8_t *)&eeStore->data, sizeof(eeStore->data));
+}
+
+void EEStore::writeBytes(int address, const uint8_t *bytes, int size) {
+  for (int i = 0; i < size; i++, address++) {
+    if (EEPROM.read(address) != bytes[i]) {
+      EEPROM.write(address, bytes[i]);
+      bytesWritten++;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CRC-8 (polynomial x^8+x^2+x+1), calculated a bit at a time to save flash.
+
+uint8_t EEStore::crc8(uint8_t crc, uint8_t byte) {
+  crc ^= byte;
+  for (uint8_t bit = 0; bit < 8; bit++)
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  return crc;
+}
+
+uint8_t EEStore::definitionsCrc() {
+  uint8_t crc = 0;
+  for (int address = sizeof(EEStore); address < eeStore->data.journalStart; address++) {
+    uint8_t byte;
+    readBytes(address, &byte, 1);
+    crc = crc8(crc, byte);
+  }
+  return crc;
+}
+
+// Generation numbers run from 0 to 253, so that they alternate between even and
+// odd when they wrap round, and are never 255 (the value of erased EEPROM).
+uint8_t EEStore::nextGeneration() {
+  uint8_t generation = eeStore->data.journalGeneration + 1;
+  return (generation >= 254) ? 0 : generation;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// State journal.  Each half of the journal area holds a whole number of records.
+
+int EEStore::journalHalfSize() {
+  int size = (EEPROM.length() - eeStore->data.journalStart) / 2;
+  return size - size % sizeof(EEStoreJournalRecord);
+}
+
+int EEStore::journalHalfStart() {
+  return journalHalfStart(eeStore->data.journalGeneration);
+}
+
+int EEStore::journalHalfStart(uint8_t generation) {
+  return eeStore->data.journalStart + ((generation & 1) ? journalHalfSize() : 0);
+}
+
+// Read the valid records in the current half of the journal, keeping the latest
+// state of each turnout and output to override the state in its definition when
+// it is loaded.  The journal ends at the first record which isn't valid.
+void EEStore::loadJournal() {
+  int halfEnd = journalHalfStart() + journalHalfSize();
+  for (journalEnd = journalHalfStart(); journalEnd < halfEnd; journalEnd += sizeof(EEStoreJournalRecord)) {
+    EEStoreJournalRecord record;
+    EEPROM.get(journalEnd, record);
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < offsetof(EEStoreJournalRecord, crc); i++)
+      crc = crc8(crc, ((uint8_t *)&record)[i]);
+    if (record.generation != eeStore->data.journalGeneration || record.crc != crc) break;
+    if (record.kind == STATE_TURNOUT) 
+      turnoutStates.insert(record.id, record.state);
+    else if (record.kind == STATE_OUTPUT)
+      outputStates.insert(record.id, record.state);
+#ifdef SAVE_LOCO_STATES
+    else if (record.kind >= STATE_LOCO && record.kind < STATE_LOCO+4) {
+      uint8_t shift = (record.kind - STATE_LOCO) * 8;
+      uint32_t value = locoStates.find(record.id, 0);
+      value = (value & ~(0xFFUL << shift)) | ((uint32_t)record.state << shift);
+      locoStates.insert(record.id, value);
+    } else if (record.kind == STATE_LOCO_FORGET_ALL)
+      locoStates.clear();
+#endif
+  }
+}
+
+// Called while loading definitions.  Returns the state from the journal, if any, 
+// otherwise the state from the definition.
+uint8_t EEStore::restoredState(uint8_t kind, uint16_t id, uint8_t state) {
+  if (kind == STATE_TURNOUT)
+    return turnoutStates.find(id, state);
+  else
+    return outputStates.find(id, state);
+}
+
+// Set up a record to be written by writeNextByte(), a byte at a time.
+void EEStore::startRecord(int address, uint8_t generation, uint8_t kind, uint16_t id, uint8_t state) {
+  outRecord.generation = generation;
+  outRecord.kind = kind;
+  outRecord.id = id;
+  outRecord.state = state;
+  outRecord.crc = 0;
+  for (uint8_t i = 0; i < offsetof(EEStoreJournalRecord, crc); i++)
+    outRecord.crc = crc8(outRecord.crc, ((uint8_t *)&outRecord)[i]);
+  outAddress = address;
+  outInvalidate = address + sizeof(EEStoreJournalRecord);
+  if (outInvalidate + (int)sizeof(EEStoreJournalRecord) > journalHalfStart(generation) + journalHalfSize())
+    outInvalidate = -1;  // Last slot in the half
+  outIndex = 0;
+  outBusy = true;
+}
+
+// Write the next changed byte of the record in progress, if the EEPROM is ready 
+// for it.  The generation byte of the following slot is set to 0xFF first, so 
+// that the journal will end there, and the generation byte of the record is 
+// written last, so that the record doesn't become valid until it is complete.
+void EEStore::writeNextByte() {
+  while (outIndex <= sizeof(EEStoreJournalRecord)) {
+    if (!eepromReady()) return;
+    int address;
+    uint8_t byte;
+    if (outIndex == 0) {
+      outIndex++;
+      if (outInvalidate < 0) continue;
+      address = outInvalidate + offsetof(EEStoreJournalRecord, generation);
+      byte = 0xFF;
+    } else {
+      if (outAddress < 0) break;
+      uint8_t i = outIndex++ % sizeof(EEStoreJournalRecord);  // 1 to 5, then 0
+      address = outAddress + i;
+      byte = ((uint8_t *)&outRecord)[i];
+    }
+    if (EEPROM.read(address) != byte) {
+      EEPROM.write(address, byte);
+      bytesWritten++;
+      return;
+    }
+  }
+  outBusy = false;
+}
+
+// The current half is full, so start a snapshot of the states which differ from 
+// the definitions in the other half, with the next generation.  The snapshot is 
+// written a record at a time by compactStep().  The header is only updated when 
+// the snapshot is complete, so if power is lost part way through, the old half 
+// is still used.
+void EEStore::startCompaction() {
+  compactGeneration = nextGeneration();
+  compactEnd = journalHalfStart(compactGeneration);
+  snapshotPhase = 0;
+  snapshotIndex = 0;
+  compacting = true;
+  // Mark the first slot invalid, in case the snapshot is empty.
+  outAddress = -1;
+  outInvalidate = compactEnd;
+  outIndex = 0;
+  outBusy = true;
+}
+
+void EEStore::compactStep() {
+  if (!eepromReady()) return;  // Finding the changed states reads the EEPROM
+  uint8_t kind, state;
+  uint16_t id;
+  if (compactEnd + (int)sizeof(EEStoreJournalRecord) <= journalHalfStart(compactGeneration) + journalHalfSize()
+      && nextSnapshotState(kind, id, state)) {
+    startRecord(compactEnd, compactGeneration, kind, id, state);
+    compactEnd += sizeof(EEStoreJournalRecord);
+    return;
+  }
+  // Snapshot complete, or the half is full, in which case the remaining
+  // states aren't saved.  Switch to the new half.
+  eeStore->data.journalGeneration = compactGeneration;
+  journalEnd = compactEnd;
+  writeHeader();
+  compacting = false;
+  justCompacted = true;
+  compactions++;
+}
+
+// Find the next state for the snapshot: turnouts, then outputs, then locos.
+bool EEStore::nextSnapshotState(uint8_t &kind, uint16_t &id, uint8_t &state) {
+  switch (snapshotPhase) {
+    case 0:
+      kind = STATE_TURNOUT;
+      if (Turnout::nextChangedState(snapshotIndex, id, state)) return true;
+      snapshotPhase++;
+      snapshotIndex = 0;
+      // fall through
+    case 1:
+      kind = STATE_OUTPUT;
+      if (Output::nextChangedState(snapshotIndex, id, state)) return true;
+      snapshotPhase++;
+      snapshotIndex = 0;
+      // fall through
+#ifdef SAVE_LOCO_STATES
+    case 2:
+      if (nextLocoState(snapshotIndex, kind, id, state)) return true;
+      snapshotPhase++;
+      // fall through
+#endif
+    default:
+      return false;
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -105,8 +418,182 @@ void EEStore::dump(int num) {
     DIAG(F("%d     %x    %c"), n, b, isprint(b) ? b : ' ');
   }
 }
+///////////////////////////////////////////////////////////////////////////////
+// Write-behind of states.  EEPROM writes are slow (3.3ms per byte on AVR, 
+// and longer for an external I2C EEPROM) and wear the EEPROM, so a turnout or 
+// output that changes state is noted here instead of being written at once.  
+// If the same object is updated again before it is written, only the last state
+// is kept.  If the queue is full, the update is dropped and a snapshot of all the 
+// states is written to the journal instead, so the caller is never held up.
+
+void EEStore::saveState(uint8_t kind, uint16_t id, uint8_t state) {
+  updatesRequested++;
+  for (uint8_t i = 0; i < pendingCount; i++) {
+    if (pendingWrites[i].kind == kind && pendingWrites[i].id == id) {
+      pendingWrites[i].state = state;  // Coalesce with earlier update
+      return;
+    }
+  }
+  if (pendingCount >= pendingSize) {
+    snapshotNeeded = true;
+    updatesOverflowed++;
+    return;
+  }
+  pendingWrites[pendingCount].kind = kind;
+  pendingWrites[pendingCount].id = id;
+  pendingWrites[pendingCount].state = state;
+  pendingCount++;
+}
+
+// Called from the main loop.  Write a byte of the record in progress, or start 
+// writing the next pending update if it's time.
+void EEStore::loop() {
+  if (!journalStep(flushing || millis() - lastWriteTime >= writeInterval))
+    flushing = false;
+}
+
+// Write the pending updates from loop() without waiting between them, e.g. 
+// when track power is switched off, as the command station may be switched 
+// off next.
+void EEStore::flush() {
+  flushing = true;
+}
+
+// Do the next step of writing the journal.  Returns false if there is nothing
+// more to write.
+bool EEStore::journalStep(bool due) {
+  if (outBusy) {
+    writeNextByte();
+    return true;
+  }
+  if (compacting) {
+    compactStep();
+    return true;
+  }
+  if (snapshotNeeded) {
+    if (!due) return true;
+    // The snapshot includes the current state of everything queued.
+    pendingCount = 0;
+    snapshotNeeded = false;
+    if (journalHalfSize() > 0) startCompaction();
+    lastWriteTime = millis();
+    return true;
+  }
+  if (pendingCount == 0) return false;
+  if (!due) return true;
+  int halfEnd = journalHalfStart() + journalHalfSize();
+  bool fits = journalEnd + (int)sizeof(EEStoreJournalRecord) <= halfEnd;
+  if (!fits && !justCompacted && journalHalfSize() > 0) {
+    startCompaction();  // The update is written when the snapshot is complete
+    return true;
+  }
+  // If there is still no room after compacting, the update is lost.
+  PendingWrite &pw = pendingWrites[0];
+  if (fits) {
+    startRecord(journalEnd, eeStore->data.journalGeneration, pw.kind, pw.id, pw.state);
+    journalEnd += sizeof(EEStoreJournalRecord);
+    justCompacted = false;
+    updatesWritten++;
+  }
+  pendingCount--;
+  memmove(&pendingWrites[0], &pendingWrites[1], pendingCount * sizeof(PendingWrite));
+  lastWriteTime = millis();
+  return true;
+}
+
+#ifdef SAVE_LOCO_STATES
+// Queue the state of a loco, as four records.  Returns false if there isn't room
+// in the queue, in which case the caller should try again later.
+bool EEStore::saveLocoState(int cab, bool forward, unsigned long functions) {
+  if (pendingSize - pendingCount < 4) return false;
+  uint32_t value = (functions & 0x1FFFFFFFUL) | LOCO_PRESENT | (forward ? LOCO_FORWARD : 0);
+  for (uint8_t n = 0; n < 4; n++, value >>= 8)
+    saveState(STATE_LOCO+n, cab, value & 0xFF);
+  return true;
+}
+
+// Record that a loco (or all locos if cab is 0) has been removed from the 
+// reminder table.
+void EEStore::forgetLocoState(int cab) {
+  if (cab != 0) {
+    saveState(STATE_LOCO+3, cab, 0);  // LOCO_PRESENT clear
+    return;
+  }
+  // Drop any loco updates still queued, so that none are written after the
+  // record that removes all locos.
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < pendingCount; i++) {
+    if (pendingWrites[i].kind >= STATE_LOCO && pendingWrites[i].kind < STATE_LOCO+4) continue;
+    pendingWrites[kept++] = pendingWrites[i];
+  }
+  pendingCount = kept;
+  saveState(STATE_LOCO_FORGET_ALL, 0, 0);
+}
+
+// Called when compacting the journal.  Find the next byte of the state of the 
+// locos in the reminder table, from position 'index' (four per loco), omitting 
+// function bytes which are zero.
+bool EEStore::nextLocoState(uint16_t &index, uint8_t &kind, uint16_t &id, uint8_t &state) {
+  for (; index < MAX_LOCOS * 4; index++) {
+    int reg = index / 4;
+    uint8_t n = index % 4;
+    int cab = DCC::speedTable[reg].loco;
+    if (cab <= 0) continue;
+    uint32_t value = (DCC::speedTable[reg].functions & 0x1FFFFFFFUL) | LOCO_PRESENT 
+      | ((DCC::speedTable[reg].speedCode & 0x80) ? LOCO_FORWARD : 0);
+    state = (value >> (n * 8)) & 0xFF;
+    if (state == 0 && n != 3) continue;
+    kind = STATE_LOCO + n;
+    id = cab;
+    index++;
+    return true;
+  }
+  return false;
+}
+#endif
+
+void EEStore::printStats() {
+  DIAG(F("EEPROM state updates: %l requested, %l written (%l saved), %d pending, %l overflowed"), 
+    updatesRequested, updatesWritten, updatesRequested-updatesWritten-pendingCount, pendingCount,
+    updatesOverflowed);
+  DIAG(F("EEPROM journal: %d/%d bytes used, generation %d, %d compactions"), 
+    journalEnd - journalHalfStart(), journalHalfSize(), eeStore->data.journalGeneration, compactions);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 EEStore *EEStore::eeStore = NULL;
 int EEStore::eeAddress = 0;
+EEStore::PendingWrite EEStore::pendingWrites[EEStore::pendingSize];
+uint8_t EEStore::pendingCount = 0;
+unsigned long EEStore::lastWriteTime = 0;
+unsigned long EEStore::updatesRequested = 0;
+unsigned long EEStore::updatesWritten = 0;
+unsigned long EEStore::updatesOverflowed = 0;
+bool EEStore::snapshotNeeded = false;
+bool EEStore::flushing = false;
+unsigned long EEStore::bytesWritten = 0;
+EEStoreJournalRecord EEStore::outRecord;
+int EEStore::outAddress = -1;
+int EEStore::outInvalidate = -1;
+uint8_t EEStore::outIndex = 0;
+bool EEStore::outBusy = false;
+int EEStore::journalEnd = 0;
+bool EEStore::compacting = false;
+bool EEStore::justCompacted = false;
+uint8_t EEStore::compactGeneration = 0;
+int EEStore::compactEnd = 0;
+uint8_t EEStore::snapshotPhase = 0;
+uint16_t EEStore::snapshotIndex = 0;
+uint16_t EEStore::compactions = 0;
+IdIndex<uint8_t> EEStore::turnoutStates;
+IdIndex<uint8_t> EEStore::outputStates;
+#ifdef SAVE_LOCO_STATES
+IdIndex<uint32_t> EEStore::locoStates;
+#endif
+uint8_t EEStore::buffer[EEStore::bufferCapacity];
+int EEStore::bufferStart = 0;
+int EEStore::bufferSize = 0;
+int EEStore::bufferAreaStart = 0;
+int EEStore::bufferAreaEnd = 0;
 #endif
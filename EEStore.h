@@ -33,13 +33,51 @@ extern ExternalEEPROM EEPROM;
 #include <EEPROM.h>
 #endif
 
-#define EESTORE_ID "DCC++1"
+#include "IdIndex.h"
+
+#define EESTORE_ID "DCC++2"
+#define EESTORE_ID_V1 "DCC++1"  // Format without state journal, converted when loaded
+
+// EEPROM layout:
+//   EEStore header (EEStoreData)
+//   Definitions of turnouts, sensors and outputs, written by <E>
+//   State journal, from journalStart to the end of the EEPROM, used in two halves.
+//
+// The definitions include the turnout and output states at the time of the <E>.
+// Subsequent state changes are appended to the current half of the journal as 
+// CRC-checked records, so that successive updates go to different EEPROM cells.  
+// When the half is full, a snapshot of the states which differ from the definitions 
+// is written to the other half, with the next generation number, and the header is 
+// then switched to it.  The half in use is given by the generation number (even 
+// or odd), so the switch is a single byte write.  The journal ends at the first 
+// record which isn't of the current generation, and the slot after each record is
+// marked invalid before the record is written, so records left in a half from its 
+// previous use are never read back.  Records are written a byte at a time from 
+// loop(), with the generation byte last.
+
+struct EEStoreDataV1{
+  char id[sizeof(EESTORE_ID_V1)];
+  uint16_t nTurnouts;
+  uint16_t nSensors;
+  uint16_t nOutputs;
+};
 
 struct EEStoreData{
   char id[sizeof(EESTORE_ID)];
   uint16_t nTurnouts;
   uint16_t nSensors;
   uint16_t nOutputs;
+  uint16_t journalStart;      // Address of state journal, following the definitions
+  uint8_t journalGeneration;  // Generation of valid journal records
+  uint8_t definitionsCrc;     // CRC-8 of the definitions
+};
+
+struct EEStoreJournalRecord{
+  uint8_t generation;
+  uint8_t kind;   // EEStore::STATE_TURNOUT or EEStore::STATE_OUTPUT
+  uint16_t id;
+  uint8_t state;
+  uint8_t crc;    // CRC-8 of the preceding bytes
 };
 
 struct EEStore{
@@ -53,6 +91,108 @@ struct EEStore{
   static void store();
   static void clear();
   static void dump(int);
+
+  // Read an object at the current position, and advance.  While loading, the 
+  // definitions are read through a small buffer, a block at a time.
+  template <typename T>
+  static void read(T &t) {
+    readBytes(eeAddress, (uint8_t *)&t, sizeof(T));
+    advance(sizeof(T));
+  }
+
+  // Write an object at the current position, leaving unchanged bytes alone, and advance.
+  template <typename T>
+  static void write(const T &t) {
+    writeBytes(eeAddress, (const uint8_t *)&t, sizeof(T));
+    advance(sizeof(T));
+  }
+
+  // Turnout and output states, saved in the journal.  Changes are held in RAM, 
+  // coalesced if the same object is updated again, and written in the background 
+  // no more often than once per 'writeInterval' ms.
+  enum : uint8_t {
+    STATE_TURNOUT = 1,
+    STATE_OUTPUT = 2,
+    STATE_LOCO = 0x10,            // 0x10-0x13: byte 0-3 of loco state
+    STATE_LOCO_FORGET_ALL = 0x20,
+  };
+  static void saveState(uint8_t kind, uint16_t id, uint8_t state);
+#ifdef SAVE_LOCO_STATES
+  // Loco state, saved as four bytes: functions F0-F28 in bits 0-28, 
+  // LOCO_PRESENT and LOCO_FORWARD.
+  static const uint32_t LOCO_PRESENT = 0x40000000UL;
+  static const uint32_t LOCO_FORWARD = 0x80000000UL;
+  static bool saveLocoState(int cab, bool forward, unsigned long functions);
+  static void forgetLocoState(int cab);
+#endif
+  static uint8_t restoredState(uint8_t kind, uint16_t id, uint8_t state);
+  static void loop();
+  static void flush();
+  static void printStats();
+
+private:
+  struct PendingWrite {
+    uint8_t kind;
+    uint8_t state;
+    uint16_t id;
+  };
+  static const uint8_t pendingSize = 16;
+  static const unsigned long writeInterval = 50;
+  static PendingWrite pendingWrites[pendingSize];  // In order of first update
+  static uint8_t pendingCount;
+  static unsigned long lastWriteTime;
+  static unsigned long updatesRequested;
+  static unsigned long updatesWritten;
+  static unsigned long updatesOverflowed;  // Dropped from a full queue, and covered by a snapshot
+  static bool snapshotNeeded;
+  static bool flushing;     // Write pending updates without waiting
+  static unsigned long bytesWritten;
+  static bool journalStep(bool due);
+
+  // Journal record being written
+  static EEStoreJournalRecord outRecord;
+  static int outAddress;      // Address of the record, or -1 if none
+  static int outInvalidate;   // Slot to mark invalid first, or -1 if none
+  static uint8_t outIndex;    // Next byte to write
+  static bool outBusy;
+  static void startRecord(int address, uint8_t generation, uint8_t kind, uint16_t id, uint8_t state);
+  static void writeNextByte();
+
+  static int journalEnd;    // Address for next journal record
+  static bool compacting;
+  static bool justCompacted;  // No record written since the last snapshot
+  static uint8_t compactGeneration;
+  static int compactEnd;      // Address for next snapshot record
+  static uint8_t snapshotPhase;
+  static uint16_t snapshotIndex;
+  static uint16_t compactions;
+  static void startCompaction();
+  static void compactStep();
+  static bool nextSnapshotState(uint8_t &kind, uint16_t &id, uint8_t &state);
+  static IdIndex<uint8_t> turnoutStates;  // Restored from the journal, used while loading
+  static IdIndex<uint8_t> outputStates;
+#ifdef SAVE_LOCO_STATES
+  static IdIndex<uint32_t> locoStates;
+  static bool nextLocoState(uint16_t &index, uint8_t &kind, uint16_t &id, uint8_t &state);
+#endif
+  static int journalHalfSize();
+  static int journalHalfStart();
+  static int journalHalfStart(uint8_t generation);
+  static void loadJournal();
+  static uint8_t nextGeneration();
+  static uint8_t definitionsCrc();
+  static uint8_t crc8(uint8_t crc, uint8_t byte);
+  static void writeBytes(int address, const uint8_t *bytes, int size);
+  static void readBytes(int address, uint8_t *bytes, int size);
+  static const uint8_t bufferCapacity = 64;
+  static uint8_t buffer[bufferCapacity];  // Block of the definitions while loading
+  static int bufferStart;
+  static int bufferSize;
+  static int bufferAreaStart;
+  static int bufferAreaEnd;
+  static void setBufferArea(int start, int end);
+  static void restartJournal();
+  static void writeHeader();
 };
 
 #endif
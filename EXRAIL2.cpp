@@ -52,6 +52,8 @@
 #include "Turnouts.h"
 #include "CommandDistributor.h"
 #include "TrackManager.h"
+#include "Sensors.h"
+#include "MemoryStats.h"
 
 // Command parsing keywords
 const int16_t HASH_KEYWORD_EXRAIL=15435;    
@@ -111,12 +113,22 @@ uint16_t RMFT2::getOperand(int progCounter,byte n) {
   return msb<<8|lsb;
 }
 
+#ifdef STATIC_MEMORY_POOLS
+POOL_STORAGE(lookListArenaStorage, LOOKLIST_POOL_SIZE);
+MemoryArena LookList::arena(lookListArenaStorage, LOOKLIST_POOL_SIZE);
+#endif
+
 LookList::LookList(int16_t size) {
   m_size=size;
   m_loaded=0;
   if (size) {
+#ifdef STATIC_MEMORY_POOLS
+    m_lookupArray=(int16_t *)arena.allocate(size*sizeof(int16_t));
+    m_resultArray=(int16_t *)arena.allocate(size*sizeof(int16_t));
+#else
     m_lookupArray=new int16_t[size];
     m_resultArray=new int16_t[size];
+#endif
   }
 }
 
@@ -156,6 +168,7 @@ LookList* RMFT2::LookListLoader(OPCODE op1, OPCODE op2, OPCODE op3) {
 }
 
 /* static */ void RMFT2::begin() {
+  MEMORY_SCOPE(EXRAIL);
 
   DIAG(F("EXRAIL RoutCode at =%P"),RouteCode);
     
@@ -206,6 +219,10 @@ LookList* RMFT2::LookListLoader(OPCODE op1, OPCODE op2, OPCODE op3) {
 
     case OPCODE_ATGTE:
     case OPCODE_ATLT:
+      // Ask the driver to tell us when the threshold is crossed, so waiting tasks
+      // can be woken immediately.
+      IOAnalogueWatch::add((VPIN)operand,(int)getOperand(progCounter,1),0,analogueWatchCallback);
+      /* fallthrough */
     case OPCODE_IFGTE:
     case OPCODE_IFLT:
     case OPCODE_DRIVE: {
@@ -259,6 +276,7 @@ LookList* RMFT2::LookListLoader(OPCODE op1, OPCODE op2, OPCODE op3) {
 }
 
 void RMFT2::setTurnoutHiddenState(Turnout * t) {
+  if (!t) return;  // Turnout not created
   // turnout descriptions are in low flash F strings
   const FSH *desc = getTurnoutDescription(t->getId());
   if (desc) t->setHidden(GETFLASH(desc)==0x01);
@@ -373,6 +391,7 @@ bool RMFT2::parseSlash(Print * stream, byte & paramCount, int16_t p[]) {
       uint16_t cab=(paramCount==2)? 0 : p[1];
       int pc=sequenceLookup->find(route);
       if (pc<0) return false;
+      MEMORY_SCOPE(EXRAIL);  // Task creation
       RMFT2* task=new RMFT2(pc);
       task->loco=cab;
     }
@@ -493,6 +512,7 @@ RMFT2::~RMFT2() {
 void RMFT2::createNewTask(int route, uint16_t cab) {
       int pc=sequenceLookup->find(route);
       if (pc<0) return;
+      MEMORY_SCOPE(EXRAIL);  // Task creation
       RMFT2* task=new RMFT2(pc);
       task->loco=cab;
 }
@@ -649,13 +669,13 @@ void RMFT2::loop2() {
   case OPCODE_ATGTE: // wait for analog sensor>= value
     timeoutFlag=false;
     if (IODevice::readAnalogue(operand) >= (int)(getOperand(1))) break;
-    delayMe(50);
+    delayMe(analogueWaitTime(operand));
     return;
     
   case OPCODE_ATLT: // wait for analog sensor < value
     timeoutFlag=false;
     if (IODevice::readAnalogue(operand) < (int)(getOperand(1))) break;
-    delayMe(50);
+    delayMe(analogueWaitTime(operand));
     return;
       
   case OPCODE_ATTIMEOUT1:   // ATTIMEOUT(vpin,timeout) part 1
@@ -727,6 +747,10 @@ void RMFT2::loop2() {
       }
       break; 
 
+  case OPCODE_SENSOR_DEBOUNCE:
+    Sensor::setDebounce(operand, getOperand(1));
+    break;
+
   case OPCODE_RESUME:
     pausingTask=NULL;
     driveLoco(speedo);
@@ -929,6 +953,7 @@ void RMFT2::loop2() {
     {
       int newPc=sequenceLookup->find(operand);
       if (newPc<0) break;
+      MEMORY_SCOPE(EXRAIL);  // Task creation
       new RMFT2(newPc);
     }
     break;
@@ -937,6 +962,7 @@ void RMFT2::loop2() {
     {
       int newPc=sequenceLookup->find(getOperand(1));
       if (newPc<0) break;
+      MEMORY_SCOPE(EXRAIL);  // Task creation
       RMFT2* newtask=new RMFT2(newPc); // create new task
       newtask->loco=operand;
     }
@@ -999,6 +1025,27 @@ void RMFT2::loop2() {
   SKIPOP;
 }
 
+// Analogue inputs on drivers that evaluate watches wake the waiting task via
+// analogueWatchCallback, so only need an occasional check as a safety net.
+long RMFT2::analogueWaitTime(VPIN vpin) {
+  return IODevice::hasAnalogueNotify(vpin) ? 1000 : 50;
+}
+
+// Called from the HAL when an analogue input crosses a threshold registered
+// for an ATGTE/ATLT.  Wakes any task waiting on that input.
+/* static */ void RMFT2::analogueWatchCallback(VPIN vpin, int value, bool above) {
+  (void)value; (void)above;
+  if (loopTask==NULL) return;
+  RMFT2 * task=loopTask;
+  do {
+    int progCounter=task->progCounter;
+    byte opcode=GET_OPCODE;
+    if ((opcode==OPCODE_ATGTE || opcode==OPCODE_ATLT) && getOperand(progCounter,0)==vpin)
+      task->delayTime=0;
+    task=task->next;
+  } while (task!=loopTask);
+}
+
 void RMFT2::delayMe(long delay) {
   delayTime=delay;
   delayStart=millis();
@@ -1019,6 +1066,7 @@ bool RMFT2::getFlag(VPIN id,byte mask) {
 }
 
 void RMFT2::kill(const FSH * reason, int operand) {
+  MEMORY_SCOPE(EXRAIL);  // Task deletion
   if (reason) DIAG(F("EXRAIL ERROR pc=%d, cab=%d, %S %d"), progCounter,loco, reason, operand);
   else if (diag) DIAG(F("ENDTASK at pc=%d"), progCounter);
   delete this;
@@ -1156,6 +1204,7 @@ void RMFT2::handleEvent(const FSH* reason,LookList* handlers, int16_t id) {
     if (task==loopTask) break;
   }
   
+  MEMORY_SCOPE(EXRAIL);  // Task creation
   task=new RMFT2(pc);  // new task starts at this instruction
   task->onEventStartPosition=pc; // flag for recursion detector
 }
@@ -1216,7 +1265,10 @@ void RMFT2::thrungeString(uint32_t strfar, thrunger mode, byte id) {
     case thrunge_broadcast:
     case thrunge_lcd:
     default:    // thrunge_lcd+1, ...
-         if (!buffer) buffer=new StringBuffer();
+         if (!buffer) {
+           MEMORY_SCOPE(EXRAIL);
+           buffer=new StringBuffer();
+         }
          buffer->flush();
          stream=buffer;
          break; 
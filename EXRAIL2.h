@@ -57,7 +57,7 @@ enum OPCODE : byte {OPCODE_THROW,OPCODE_CLOSE,
              OPCODE_ROSTER,OPCODE_KILLALL,
              OPCODE_ROUTE,OPCODE_AUTOMATION,OPCODE_SEQUENCE,
              OPCODE_ENDTASK,OPCODE_ENDEXRAIL,
-             OPCODE_SET_TRACK,
+             OPCODE_SET_TRACK,OPCODE_SENSOR_DEBOUNCE,
              OPCODE_ONRED,OPCODE_ONAMBER,OPCODE_ONGREEN,
              OPCODE_ONCHANGE,
              OPCODE_ONCLOCKTIME,
@@ -110,6 +110,11 @@ class LookList {
     LookList(int16_t size);
     void add(int16_t lookup, int16_t result);
     int16_t find(int16_t value);
+#ifdef STATIC_MEMORY_POOLS
+    // Lists are created at startup and never deleted.
+    static MemoryArena arena;
+    static void *operator new(size_t size) { return arena.allocate(size); }
+#endif
   private:
      int16_t m_size;
      int16_t m_loaded;
@@ -163,6 +168,8 @@ private:
     static RMFT2 * loopTask;
     static RMFT2 * pausingTask;
     void delayMe(long millisecs);
+    static long analogueWaitTime(VPIN vpin);
+    static void analogueWatchCallback(VPIN vpin, int value, bool above);
     void driveLoco(byte speedo);
     bool readSensor(uint16_t sensorId);
     bool skipIfBlock();
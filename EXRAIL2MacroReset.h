@@ -116,6 +116,7 @@
 #undef ROSTER 
 #undef ROUTE
 #undef SENDLOCO 
+#undef SENSOR_DEBOUNCE
 #undef SEQUENCE 
 #undef SERIAL 
 #undef SERIAL1 
@@ -241,6 +242,7 @@
 #define ROUTE(id,description)
 #define ROSTER(cab,name,funcmap...)
 #define SENDLOCO(cab,route) 
+#define SENSOR_DEBOUNCE(id,ms)
 #define SEQUENCE(id) 
 #define SERIAL(msg) 
 #define SERIAL1(msg) 
@@ -347,6 +347,7 @@ const  HIGHFLASH  int16_t RMFT2::SignalDefinitions[] = {
 #define ROSTER(cabid,name,funcmap...)
 #define ROUTE(id, description)  OPCODE_ROUTE, V(id), 
 #define SENDLOCO(cab,route) OPCODE_SENDLOCO,V(cab),OPCODE_PAD,V(route),
+#define SENSOR_DEBOUNCE(id,ms) OPCODE_SENSOR_DEBOUNCE,V(id),OPCODE_PAD,V(ms),
 #define SEQUENCE(id)  OPCODE_SEQUENCE, V(id), 
 #define SERIAL(msg) PRINT(msg)
 #define SERIAL1(msg) PRINT(msg)
@@ -29,6 +29,7 @@
 #include "CommandDistributor.h"
 #include "WiThrottle.h"
 #include "DCCTimer.h"
+#include "MemoryStats.h"
 
 EthernetInterface * EthernetInterface::singleton=NULL;
 /**
@@ -37,6 +38,7 @@ EthernetInterface * EthernetInterface::singleton=NULL;
  */
 void EthernetInterface::setup()
 {
+  MEMORY_SCOPE(NETWORK);
   if (singleton!=NULL) {
     DIAG(F("Prog Error!"));
     return;
@@ -133,6 +135,7 @@ bool EthernetInterface::checkLink() {
   if (Ethernet.linkStatus() != LinkOFF) { // check for not linkOFF instead of linkON as the W5100 does return LinkUnknown
     //if we are not connected yet, setup a new server
     if(!connected) {
+      MEMORY_SCOPE(NETWORK);
       DIAG(F("Ethernet cable connected"));
       connected=true;
       #ifdef IP_ADDRESS
@@ -150,6 +153,7 @@ bool EthernetInterface::checkLink() {
     }
     return true;
   } else { // connected
+    MEMORY_SCOPE(NETWORK);
     DIAG(F("Ethernet cable disconnected"));
     connected=false;
     //clean up any client
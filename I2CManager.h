@@ -536,6 +536,15 @@ private:
     uint8_t muxPhase = 0;
     uint8_t muxAddress = 0;
     uint8_t muxData[1];
+#if defined(I2C_EXTENDED_ADDRESS)
+    // Mux and sub-bus known to be selected, so that a request to a device on
+    // the same sub-bus doesn't need the mux selecting again.
+    I2CMux selectedMux = I2CMux_None;
+    I2CSubBus selectedSubBus = SubBus_None;
+    static bool sameSubBus(I2CAddress a, I2CAddress b) {
+      return a.muxNumber() == b.muxNumber() && a.subBus() == b.subBus();
+    }
+#endif
     uint8_t deviceAddress;
     const uint8_t *sendBuffer;
     uint8_t *receiveBuffer;
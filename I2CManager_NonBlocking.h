@@ -126,9 +126,22 @@ void I2CManagerClass::startTransaction() {
       // Start the I2C process going.
 #if defined(I2C_EXTENDED_ADDRESS)
       I2CMux muxNumber = currentRequest->i2cAddress.muxNumber();
-      if (muxNumber != I2CMux_None) {
+      uint8_t subBus = currentRequest->i2cAddress.subBus();
+      if (muxNumber != I2CMux_None && muxNumber == selectedMux && subBus == selectedSubBus
+          && currentRequest->i2cAddress.deviceAddress() != 0) {
+        // Sub-bus still selected from the previous request, so go straight
+        // to the payload.
+        muxPhase = MuxPhase_PAYLOAD;
+        deviceAddress = currentRequest->i2cAddress.deviceAddress();
+        sendBuffer = currentRequest->writeBuffer;
+        bytesToSend = currentRequest->writeLen;
+        receiveBuffer = currentRequest->readBuffer;
+        bytesToReceive = currentRequest->readLen;
+        operation = currentRequest->operation & OPERATION_MASK;
+      } else if (muxNumber != I2CMux_None) {
         muxPhase = MuxPhase_PROLOG;
-        uint8_t subBus = currentRequest->i2cAddress.subBus();
+        // Mux state unknown until the prolog has completed.
+        selectedMux = I2CMux_None;
         muxData[0] = (subBus == SubBus_All) ? 0xff :
                      (subBus == SubBus_None) ? 0x00 :
 #if defined(I2CMUX_PCA9547)
@@ -267,6 +280,9 @@ void I2CManagerClass::checkForTimeout() {
           delayMicroseconds(10);        // ... for 5us (100kHz Clock)
         }
         // Whether that's succeeded or not, now try reinitialising.
+#if defined(I2C_EXTENDED_ADDRESS)
+        selectedMux = I2CMux_None;  // Mux state unknown
+#endif
         I2C_init();
         _setClock(_clockSpeed);
         state = I2C_STATE_FREE;
@@ -309,6 +325,10 @@ void I2CManagerClass::handleInterrupt() {
 #if defined(I2C_EXTENDED_ADDRESS)
       if (muxPhase == MuxPhase_PROLOG ) {
         overallStatus = completionStatus;
+        if (completionStatus == I2C_STATUS_OK) {
+          selectedMux = currentRequest->i2cAddress.muxNumber();
+          selectedSubBus = currentRequest->i2cAddress.subBus();
+        }
         uint8_t rbAddress = currentRequest->i2cAddress.deviceAddress();
         if (completionStatus == I2C_STATUS_OK && rbAddress != 0) {
           // Mux request OK, start handling application request.
@@ -330,8 +350,13 @@ void I2CManagerClass::handleInterrupt() {
         if (_muxCount == 1) {
           // Only one MUX, don't need to deselect subbus
           muxPhase = MuxPhase_OFF;
+        } else if (currentRequest->nextRequest
+            && sameSubBus(currentRequest->nextRequest->i2cAddress, currentRequest->i2cAddress)) {
+          // Next request is for the same sub-bus, so leave it selected.
+          muxPhase = MuxPhase_OFF;
         } else {
           muxPhase = MuxPhase_EPILOG;
+          selectedMux = I2CMux_None;
           deviceAddress = I2C_MUX_BASE_ADDRESS + currentRequest->i2cAddress.muxNumber();
           muxData[0] = 0x00;
           sendBuffer = &muxData[0];
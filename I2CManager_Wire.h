@@ -69,11 +69,17 @@ void I2CManagerClass::setTimeout(unsigned long value) {
  * Helper function for I2C Multiplexer operations
  ********************************************************/
 #ifdef I2C_EXTENDED_ADDRESS
+// Mux and sub-bus known to be selected by the last call to muxSelect.
+static I2CMux selectedMux = I2CMux_None;
+static I2CSubBus selectedSubBus = SubBus_None;
+
 static uint8_t muxSelect(I2CAddress address) {
   // Select MUX sub bus.
   I2CMux muxNo = address.muxNumber();
   I2CSubBus subBus = address.subBus();
   if (muxNo != I2CMux_None) {
+    // Nothing to send if the sub-bus is still selected.
+    if (muxNo == selectedMux && subBus == selectedSubBus) return I2C_STATUS_OK;
     Wire.beginTransmission(I2C_MUX_BASE_ADDRESS+muxNo); 
     uint8_t data =  (subBus == SubBus_All) ? 0xff :
                     (subBus == SubBus_None) ? 0x00 :
@@ -87,7 +93,13 @@ static uint8_t muxSelect(I2CAddress address) {
                     1 << subBus;
 #endif
     Wire.write(&data, 1);
-    return Wire.endTransmission(true);  // have to release I2C bus for it to work
+    uint8_t status = Wire.endTransmission(true);  // have to release I2C bus for it to work
+    if (status == I2C_STATUS_OK) {
+      selectedMux = muxNo;
+      selectedSubBus = subBus;
+    } else 
+      selectedMux = I2CMux_None;  // Mux state unknown
+    return status;
   }
   return I2C_STATUS_OK;
 }
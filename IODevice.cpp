@@ -26,6 +26,7 @@
 #include "FSH.h"
 #include "IO_MCP23017.h"
 #include "DCCTimer.h"
+#include "MemoryStats.h"
 
 #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
 #define USE_FAST_IO
@@ -48,6 +49,7 @@ extern __attribute__((weak)) void exrailHalSetup();
 // Create any standard device instances that may be required, such as the Arduino pins 
 // and PCA9685.
 void IODevice::begin() {
+  MEMORY_SCOPE(HAL);
   // Initialise the IO subsystem defaults
   ArduinoPins::create(2, NUM_DIGITAL_PINS-2);  // Reserve pins for direct access
 
@@ -183,6 +185,13 @@ bool IODevice::hasCallback(VPIN vpin) {
   return dev->_hasCallback;
 }
 
+// check whether the pin's driver evaluates analogue watches when new samples arrive.
+bool IODevice::hasAnalogueNotify(VPIN vpin) {
+  IODevice *dev = findDevice(vpin);
+  if (!dev) return false;
+  return dev->_hasAnalogueNotify;
+}
+
 // Display (to diagnostics) details of the device.
 void IODevice::_display() {
   DIAG(F("Unknown device Vpins:%u-%u %S"), 
@@ -366,6 +375,13 @@ bool IODevice::checkNoOverlap(VPIN firstPin, uint8_t nPins, I2CAddress i2cAddres
 
 // Chain of callback blocks (identifying registered callback functions for state changes)
 IONotifyCallback *IONotifyCallback::first = 0;
+#ifdef STATIC_MEMORY_POOLS
+POOL_STORAGE(callbackPoolStorage, POOL_BLOCK_SIZE(sizeof(IONotifyCallback)) * CALLBACK_POOL_SIZE);
+MemoryPool IONotifyCallback::pool(callbackPoolStorage, POOL_BLOCK_SIZE(sizeof(IONotifyCallback)), CALLBACK_POOL_SIZE);
+#endif
+
+// Chain of analogue watch blocks (identifying registered thresholds and callback functions)
+IOAnalogueWatch *IOAnalogueWatch::first = 0;
 
 // Start and end of chain of devices.
 IODevice *IODevice::_firstDevice = 0;
@@ -405,6 +421,7 @@ void IODevice::write(VPIN vpin, int value) {
 void IODevice::writeAnalogue(VPIN, int, uint8_t, uint16_t) {}
 bool IODevice::isBusy(VPIN) { return false; }
 bool IODevice::hasCallback(VPIN) { return false; }
+bool IODevice::hasAnalogueNotify(VPIN) { return false; }
 int IODevice::read(VPIN vpin) { 
   if (vpin >= NUM_DIGITAL_PINS) return 0;
   return !digitalRead(vpin);  // Return inverted state (5v=0, 0v=1)
@@ -425,6 +442,11 @@ void IODevice::setGPIOInterruptPin(int16_t) {}
 // Chain of callback blocks (identifying registered callback functions for state changes)
 // Not used in IO_NO_HAL but must be declared.
 IONotifyCallback *IONotifyCallback::first = 0;
+IOAnalogueWatch *IOAnalogueWatch::first = 0;
+#ifdef STATIC_MEMORY_POOLS
+POOL_STORAGE(callbackPoolStorage, POOL_BLOCK_SIZE(sizeof(IONotifyCallback)) * CALLBACK_POOL_SIZE);
+MemoryPool IONotifyCallback::pool(callbackPoolStorage, POOL_BLOCK_SIZE(sizeof(IONotifyCallback)), CALLBACK_POOL_SIZE);
+#endif
 
 #endif // IO_NO_HAL
 
@@ -43,6 +43,7 @@
 #include "DIAG.h"
 #include "FSH.h"
 #include "I2CManager.h"
+#include "MemoryPool.h"
 #include "inttypes.h"
 
 typedef uint16_t VPIN;
@@ -54,30 +55,115 @@ typedef uint16_t VPIN;
 /* 
  * Callback support for state change notification from an IODevice subclass to a 
  * handler, e.g. Sensor object handling.
+ * 
+ * Handlers may be registered per pin (called once for each changed pin) or per port
+ * (called once for a group of up to 32 consecutive pins, with a mask of the pins that
+ * have changed and their new states, bit 0 corresponding to firstVpin).  Drivers may
+ * notify either way; the notification is converted as necessary for each handler.
+ * In newStates, a 1 bit means active (i.e. as returned by IODevice::read).
  */
 
 class IONotifyCallback {
 public: 
   typedef void IONotifyCallbackFunction(VPIN vpin, int value);
+  typedef void IONotifyPortCallbackFunction(VPIN firstVpin, uint32_t changedMask, uint32_t newStates);
+#ifdef STATIC_MEMORY_POOLS
+  static MemoryPool pool;
+  static void *operator new(size_t size) { (void)size; return pool.allocate(); }
+#endif
   static void add(IONotifyCallbackFunction *function) {
-    IONotifyCallback *blk = new IONotifyCallback(function);
+    IONotifyCallback *blk = new IONotifyCallback(function, NULL);
+    if (first) blk->next = first;
+    first = blk;
+  }
+  static void addPort(IONotifyPortCallbackFunction *function) {
+    IONotifyCallback *blk = new IONotifyCallback(NULL, function);
     if (first) blk->next = first;
     first = blk;
   }
   static void invokeAll(VPIN vpin, int value) {
-    for (IONotifyCallback *blk = first; blk != NULL; blk = blk->next)
-      blk->invoke(vpin, value);
+    for (IONotifyCallback *blk = first; blk != NULL; blk = blk->next) {
+      if (blk->invoke) 
+        blk->invoke(vpin, value);
+      else
+        blk->invokePort(vpin, 1, value ? 1 : 0);
+    }
+  }
+  static void invokeAllPort(VPIN firstVpin, uint32_t changedMask, uint32_t newStates) {
+    for (IONotifyCallback *blk = first; blk != NULL; blk = blk->next) {
+      if (blk->invokePort) 
+        blk->invokePort(firstVpin, changedMask, newStates);
+      else {
+        // Visit only the changed bits, lowest first.
+        for (uint32_t mask = changedMask; mask != 0; mask &= mask - 1) {
+          uint8_t bit = __builtin_ctzl(mask);
+          blk->invoke(firstVpin + bit, (newStates >> bit) & 1);
+        }
+      }
+    }
   }
   static bool hasCallback() {
     return first != NULL;
   }
 private:
-  IONotifyCallback(IONotifyCallbackFunction *function) { invoke = function; };
+  IONotifyCallback(IONotifyCallbackFunction *function, IONotifyPortCallbackFunction *portFunction) { 
+    invoke = function; 
+    invokePort = portFunction;
+  };
   IONotifyCallback *next = 0;
   IONotifyCallbackFunction *invoke = 0;
+  IONotifyPortCallbackFunction *invokePort = 0;
   static IONotifyCallback *first;
 };
 
+/*
+ * Threshold watch support for analogue inputs.  A watch is registered for a VPIN with
+ * a threshold and a hysteresis.  Drivers that sample analogue inputs in the background
+ * call evaluate() whenever a new sample arrives, and the watch's function is invoked
+ * when the value rises to the threshold or above, or falls below (threshold-hysteresis).
+ * This allows consumers (e.g. EXRAIL ATGTE/ATLT) to react to a crossing without
+ * repeatedly polling readAnalogue().
+ */
+
+class IOAnalogueWatch {
+public:
+  typedef void IOAnalogueWatchFunction(VPIN vpin, int value, bool above);
+  static void add(VPIN vpin, int threshold, uint16_t hysteresis, IOAnalogueWatchFunction *function) {
+    // Don't register the same watch twice.
+    for (IOAnalogueWatch *blk = first; blk != NULL; blk = blk->next)
+      if (blk->vpin == vpin && blk->threshold == threshold && blk->invoke == function) return;
+    IOAnalogueWatch *blk = new IOAnalogueWatch(vpin, threshold, hysteresis, function);
+    if (first) blk->next = first;
+    first = blk;
+  }
+  static void evaluate(VPIN vpin, int value) {
+    for (IOAnalogueWatch *blk = first; blk != NULL; blk = blk->next) {
+      if (blk->vpin != vpin) continue;
+      if (!blk->above && value >= blk->threshold) {
+        blk->above = true;
+        blk->invoke(vpin, value, true);
+      } else if (blk->above && value < blk->threshold - (int)blk->hysteresis) {
+        blk->above = false;
+        blk->invoke(vpin, value, false);
+      }
+    }
+  }
+  static bool hasWatch() {
+    return first != NULL;
+  }
+private:
+  IOAnalogueWatch(VPIN pin, int thresholdValue, uint16_t hysteresisValue, IOAnalogueWatchFunction *function) {
+    vpin = pin; threshold = thresholdValue; hysteresis = hysteresisValue; invoke = function;
+  };
+  IOAnalogueWatch *next = 0;
+  IOAnalogueWatchFunction *invoke = 0;
+  VPIN vpin;
+  int threshold;
+  uint16_t hysteresis;
+  bool above = false;  // Initially below threshold, so a first sample above it is notified.
+  static IOAnalogueWatch *first;
+};
+
 /*
  * IODevice class
  * 
@@ -145,6 +231,10 @@ public:
   // check whether the pin supports notification.  If so, then regular _read calls are not required.
   static bool hasCallback(VPIN vpin);
 
+  // check whether the pin's driver evaluates analogue watches (see IOAnalogueWatch) as new 
+  // samples arrive.  If so, then regular _readAnalogue calls are not required to detect crossings.
+  static bool hasAnalogueNotify(VPIN vpin);
+
   // read invokes the IODevice instance's _read method.
   static int read(VPIN vpin);
 
@@ -246,6 +336,8 @@ protected:
   I2CAddress _I2CAddress;
   // Flag whether the device supports callbacks.
   bool _hasCallback = false;
+  // Flag whether the device evaluates analogue watches.
+  bool _hasAnalogueNotify = false;
 
   // Pin number of interrupt pin for GPIO extender devices.  The extender module will pull this
   //  pin low if an input changes state.
@@ -277,6 +369,9 @@ private:
 class PCA9685 : public IODevice {
 public:
   static void create(VPIN vpin, int nPins, I2CAddress i2cAddress, uint16_t frequency = 50);
+#ifdef STATIC_MEMORY_POOLS
+  static MemoryPool servoDataPool;  // ServoData blocks for all PCA9685 modules
+#endif
   enum ProfileType : uint8_t {
     Instant = 0,  // Moves immediately between positions (if duration not specified)
     UseDuration = 0, // Use specified duration
@@ -317,6 +412,10 @@ private:
   }; // 14 bytes per element, i.e. per pin in use
   
   struct ServoData *_servoData [16];
+  static struct ServoData *newServoData();
+#ifdef STATIC_MEMORY_POOLS
+  static uint8_t _servoDataPoolStorage[];
+#endif
 
   static const uint8_t _catchupSteps = 5; // number of steps to wait before switching servo off
   static const uint8_t FLASH _bounceProfile[30];
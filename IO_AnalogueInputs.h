@@ -68,6 +68,7 @@ private:
     _nPins = (nPins > 4) ? 4 : nPins;
     _I2CAddress = i2cAddress;
     _currentPin = 0;
+    _hasAnalogueNotify = true;
     for (int8_t i=0; i<_nPins; i++)
       _value[i] = -1;
     addDevice(this);
@@ -121,6 +122,7 @@ private:
           #ifdef IO_ANALOGUE_SLOW
           DIAG(F("ADS111x VPIN:%u value:%d"), _currentPin, _value[_currentPin]);
           #endif
+          IOAnalogueWatch::evaluate(_firstVpin + _currentPin, _value[_currentPin]);
 
           // Move to next pin
           if (++_currentPin >= _nPins) _currentPin = 0;
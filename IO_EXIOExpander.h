@@ -48,6 +48,7 @@
 #include "I2CManager.h"
 #include "DIAG.h"
 #include "FSH.h"
+#include "AnalogueSlotMap.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 /*
@@ -74,6 +75,10 @@ private:
   // Constructor
   EXIOExpander(VPIN firstVpin, int nPins, I2CAddress i2cAddress) {
     _firstVpin = firstVpin;
+    // Digital input changes are notified to subscribers, so Sensors don't need polling.
+    _hasCallback = true;
+    // Analogue watches are evaluated as each new set of analogue values is received.
+    _hasAnalogueNotify = true;
     // Number of pins cannot exceed 256 (1 byte) because of I2C message structure.
     if (nPins > 256) nPins = 256;
     _nPins = nPins;
@@ -100,11 +105,19 @@ private:
 
           // See if we already have suitable buffers assigned
           if (_numDigitalPins>0) {
+            // Round up to a whole number of machine words, so that changes can be
+            // detected a word at a time (see _processDigitalChanges).
             size_t digitalBytesNeeded = (_numDigitalPins + 7) / 8;
+            digitalBytesNeeded = (digitalBytesNeeded + sizeof(unsigned int) - 1) & ~(sizeof(unsigned int) - 1);
             if (_digitalPinBytes < digitalBytesNeeded) {
-              // Not enough space, free any existing buffer and allocate a new one
-              if (_digitalPinBytes > 0) free(_digitalInputStates);
-              if ((_digitalInputStates = (byte*) calloc(digitalBytesNeeded, 1)) != NULL) {
+              // Not enough space, free any existing buffers and allocate new ones
+              if (_digitalPinBytes > 0) {
+                free(_digitalInputStates);
+                free(_digitalInputBuffer);
+              }
+              _digitalInputStates = (byte*) calloc(digitalBytesNeeded, 1);
+              _digitalInputBuffer = (byte*) calloc(digitalBytesNeeded, 1);
+              if (_digitalInputStates != NULL && _digitalInputBuffer != NULL) {
 		_digitalPinBytes = digitalBytesNeeded;
 	      } else {
 		DIAG(F("EX-IOExpander I2C:%s ERROR alloc %d bytes"), _I2CAddress.toString(), digitalBytesNeeded);
@@ -148,6 +161,7 @@ private:
       if (status == I2C_STATUS_OK && _numAnaloguePins>0) {
         commandBuffer[0] = EXIOINITA;
         status = I2CManager.read(_I2CAddress, _analoguePinMap, _numAnaloguePins, commandBuffer, 1);
+        if (status == I2C_STATUS_OK && !_buildAnalogueSlotMap()) return;
       }
       if (status == I2C_STATUS_OK) {
         // Attempt to get version, if we don't get it, we don't care, don't go offline
@@ -188,6 +202,10 @@ private:
                                 outBuffer, sizeof(outBuffer));
       if (status == I2C_STATUS_OK) {
         if (responseBuffer[0] == EXIORDY) {
+          // Treat the pin as inactive until the next scan, so that its current
+          // state is notified to subscribers (e.g. a newly created Sensor).
+          if (_digitalPinBytes > 0 && pin < _numDigitalPins)
+            bitClear(_digitalInputStates[pin / 8], pin % 8);
           return true;
         } else {
           DIAG(F("EXIOVpin %u cannot be used as a digital input pin"), (int)vpin);
@@ -244,12 +262,17 @@ private:
           // do this to avoid tearing of the values (i.e. one byte of a two-byte value being changed
           // while the value is being read).
           memcpy(_analogueInputStates, _analogueInputBuffer, _analoguePinBytes); // Copy I2C input buffer to states
+          if (IOAnalogueWatch::hasWatch()) {
+            for (uint8_t aPin = 0; aPin < _numAnaloguePins; aPin++)
+              IOAnalogueWatch::evaluate(_firstVpin + _analoguePinMap[aPin], 
+                (_analogueInputStates[aPin*2+1] << 8) + _analogueInputStates[aPin*2]);
+          }
 
         } else if (_readState == RDS_DIGITAL) {
-          // Read of digital states was in progress, so process received values 
-          // The received digital states are placed directly into the digital buffer on receipt, 
-          // so don't need any further processing at this point (unless we want to check for
-          // changes and notify them to subscribers, to avoid the need for polling - see IO_GPIOBase.h).
+          // Read of digital states was in progress, so process received values.
+          // The received states are compared with the previous ones, and any changes
+          // are notified to subscribers to avoid the need for polling (see IO_GPIOBase.h).
+          _processDigitalChanges();
         }
       } else
         reportError(status, false);   // report eror but don't go offline.
@@ -263,7 +286,7 @@ private:
         // Issue new read request for digital states.  As the request is non-blocking, the buffer has to
         // be allocated from heap (object state).
         _readCommandBuffer[0] = EXIORDD;
-        I2CManager.read(_I2CAddress, _digitalInputStates, (_numDigitalPins+7)/8, _readCommandBuffer, 1, &_i2crb);
+        I2CManager.read(_I2CAddress, _digitalInputBuffer, (_numDigitalPins+7)/8, _readCommandBuffer, 1, &_i2crb);
                                                                 // non-blocking read
         _lastDigitalRead = currentMicros;
         _readState = RDS_DIGITAL;
@@ -278,20 +301,52 @@ private:
     }
   }
 
+  // Compare the newly received digital states with the previous ones a machine word
+  // at a time, and invoke the notification callbacks for each byte that has changed.
+  // Unchanged words (the usual case) cost one XOR and a compare.
+  void _processDigitalChanges() {
+    const bool notify = IONotifyCallback::hasCallback();
+    for (uint8_t offset = 0; offset < _digitalPinBytes; offset += sizeof(unsigned int)) {
+      unsigned int oldStates, newStates;
+      memcpy(&oldStates, &_digitalInputStates[offset], sizeof(unsigned int));
+      memcpy(&newStates, &_digitalInputBuffer[offset], sizeof(unsigned int));
+      if (!(oldStates ^ newStates)) continue;
+      if (notify) {
+        // Notify the changes byte by byte, so that the pin numbering
+        // doesn't depend on the processor's byte order.
+        for (uint8_t byteNumber = offset; byteNumber < offset + sizeof(unsigned int); byteNumber++) {
+          uint8_t newByte = _digitalInputBuffer[byteNumber];
+          uint8_t differences = _digitalInputStates[byteNumber] ^ newByte;
+          if (differences)
+            IONotifyCallback::invokeAllPort(_firstVpin + byteNumber * 8, differences, newByte);
+        }
+      }
+      memcpy(&_digitalInputStates[offset], &newStates, sizeof(unsigned int));
+    }
+  }
+
+  // Build the reverse of the analogue pin map once, when the pin map is
+  // received, so that _readAnalogue doesn't have to search the pin map on every
+  // call.  Returns false (and marks the device failed) if allocation fails.
+  bool _buildAnalogueSlotMap() {
+    if (!_analogueSlotMap.build(_analoguePinMap, _numAnaloguePins)) {
+      DIAG(F("EX-IOExpander I2C:%s ERROR alloc analog slot map"), _I2CAddress.toString());
+      _deviceState = DEVSTATE_FAILED;
+      return false;
+    }
+    return true;
+  }
+
   // Obtain the correct analogue input value, with reference to the analogue
-  // pin map.  
-  // Obtain the correct analogue input value
+  // slot map.
   int _readAnalogue(VPIN vpin) override {
     if (_deviceState == DEVSTATE_FAILED) return 0;
-    int pin = vpin - _firstVpin;
-    for (uint8_t aPin = 0; aPin < _numAnaloguePins; aPin++) {
-      if (_analoguePinMap[aPin] == pin) {
-        uint8_t _pinLSBByte = aPin * 2;
-        uint8_t _pinMSBByte = _pinLSBByte + 1;
-        return (_analogueInputStates[_pinMSBByte] << 8) + _analogueInputStates[_pinLSBByte];
-      }
-    }
-    return -1;  // pin not found in table
+    unsigned int pin = vpin - _firstVpin;
+    uint8_t aPin = _analogueSlotMap.slot(pin);
+    if (aPin >= _numAnaloguePins) return -1;  // pin not found in table
+    uint8_t _pinLSBByte = aPin * 2;
+    uint8_t _pinMSBByte = _pinLSBByte + 1;
+    return (_analogueInputStates[_pinMSBByte] << 8) + _analogueInputStates[_pinLSBByte];
   }
 
   // Obtain the correct digital input value
@@ -383,6 +438,7 @@ private:
   uint8_t _patchVer = 0;
 
   uint8_t* _digitalInputStates  = NULL;
+  uint8_t* _digitalInputBuffer  = NULL;  // buffer for I2C input transfers
   uint8_t* _analogueInputStates = NULL;
   uint8_t* _analogueInputBuffer = NULL;  // buffer for I2C input transfers
   uint8_t _readCommandBuffer[1];
@@ -390,6 +446,7 @@ private:
   uint8_t _digitalPinBytes = 0;   // Size of allocated memory buffer (may be longer than needed)
   uint8_t _analoguePinBytes = 0;  // Size of allocated memory buffer (may be longer than needed)
   uint8_t* _analoguePinMap = NULL;
+  AnalogueSlotMap _analogueSlotMap;  // Reverse of _analoguePinMap, indexed by pin number
   I2CRB _i2crb;
 
   enum {RDS_IDLE, RDS_DIGITAL, RDS_ANALOGUE};  // Read operation states
@@ -159,17 +159,16 @@ void GPIOBase<T>::_loop(unsigned long currentMicros) {
   // Set unused pin and write mode pin value to 1
     _portInputState |= ~_portInUse | _portMode;
 
-    // Scan for changes in input states and invoke callback (if present)
+    // Scan for changes in input states and invoke callback (if present).
+    // The whole port is notified in one call (per 32 pins), with the
+    // input states inverted so that 1 means active (0v).
     T differences = lastPortStates ^ _portInputState;
     if (differences && IONotifyCallback::hasCallback()) {
-      // Scan for differences bit by bit
-      T mask = 1;
-      for (int pin=0; pin<_nPins; pin++) {
-        if (differences & mask) {
-          // Change detected.
-          IONotifyCallback::invokeAll(_firstVpin+pin, (_portInputState & mask) == 0);
-        }
-        mask <<= 1;
+      T activeStates = ~_portInputState;
+      for (uint8_t offset=0; offset<_nPins; offset+=32) {
+        uint32_t changedMask = (uint32_t)(differences >> offset);
+        if (changedMask)
+          IONotifyCallback::invokeAllPort(_firstVpin+offset, changedMask, (uint32_t)(activeStates >> offset));
       }
     }
 
@@ -189,9 +189,8 @@ protected:
     }
   }
 
-  void _loop(unsigned long) override {
-    screenUpdate();
-  }
+  // The screen is updated from DisplayInterface::loop(), which groups the
+  // updates of displays on the same I2C mux sub-bus, so there's no _loop().
   
   // Display information about the device.
   void _display() {
@@ -208,6 +207,18 @@ public:
     screenUpdate();
   }
 
+  uint8_t _getSubBusKey() override {
+    return subBusKey(_I2CAddress);
+  }
+
+  // Check if any row is still to be written to the screen.
+  bool _isUpdating() override {
+    if (_charPosToScreen < _numCols) return true;
+    for (uint8_t row=0; row<_numRows; row++)
+      if (_rowGeneration[row] != _lastRowGeneration[row]) return true;
+    return false;
+  }
+
   // Position on nominated line number (0 to number of lines -1)
   // Clear the line in the buffer ready for updating
   // The displayNo referenced here is remembered and any following
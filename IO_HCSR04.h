@@ -111,6 +111,7 @@ protected:
   HCSR04 (VPIN vpin, int trigPin, int echoPin, uint16_t onThreshold, uint16_t offThreshold, uint16_t options) {
     _firstVpin = vpin;
     _nPins = 1;
+    _hasAnalogueNotify = true;
     _trigPin = trigPin;
     _echoPin = echoPin;
     _onThreshold = onThreshold;
@@ -228,8 +229,10 @@ protected:
         break;
     }
     // Datasheet recommends a wait of at least 60ms between measurement cycles
-    if (_state == DORMANT)
+    if (_state == DORMANT) {
+      IOAnalogueWatch::evaluate(_firstVpin, _distance);
       delayUntil(currentMicros+60000UL); // wait 60ms till next measurement
+    }
 
   }
 
@@ -41,6 +41,21 @@ void PCA9685::create(VPIN firstVpin, int nPins, I2CAddress i2cAddress, uint16_t
   if (checkNoOverlap(firstVpin, nPins,i2cAddress)) new PCA9685(firstVpin, nPins, i2cAddress, frequency);
 }
 
+// Allocate the data for a servo pin, from the pool if STATIC_MEMORY_POOLS is defined.
+#ifdef STATIC_MEMORY_POOLS
+uint8_t PCA9685::_servoDataPoolStorage[POOL_BLOCK_SIZE(sizeof(ServoData)) * SERVO_POOL_SIZE] 
+  __attribute__((aligned(__BIGGEST_ALIGNMENT__)));
+MemoryPool PCA9685::servoDataPool(_servoDataPoolStorage, POOL_BLOCK_SIZE(sizeof(ServoData)), SERVO_POOL_SIZE);
+#endif
+
+PCA9685::ServoData *PCA9685::newServoData() {
+#ifdef STATIC_MEMORY_POOLS
+  return (struct ServoData *)servoDataPool.allocate();
+#else
+  return (struct ServoData *)calloc(1, sizeof(struct ServoData));
+#endif
+}
+
 // Configure a port on the PCA9685.
 bool PCA9685::_configure(VPIN vpin, ConfigTypeEnum configType, int paramCount, int params[]) {
   if (configType != CONFIGURE_SERVO) return false;
@@ -53,8 +68,7 @@ bool PCA9685::_configure(VPIN vpin, ConfigTypeEnum configType, int paramCount, i
   int8_t pin = vpin - _firstVpin;
   struct ServoData *s = _servoData[pin];
   if (s == NULL) { 
-    _servoData[pin] = (struct ServoData *)calloc(1, sizeof(struct ServoData));
-    s = _servoData[pin];
+    s = _servoData[pin] = newServoData();
     if (!s) return false; // Check for failed memory allocation
   }
 
@@ -156,7 +170,7 @@ void PCA9685::_writeAnalogue(VPIN vpin, int value, uint8_t profile, uint16_t dur
   struct ServoData *s = _servoData[pin];
   if (s == NULL) {
     // Servo pin not configured, so configure now using defaults
-    s = _servoData[pin] = (struct ServoData *) calloc(sizeof(struct ServoData), 1);
+    s = _servoData[pin] = newServoData();
     if (s == NULL) return;  // Check for memory allocation failure
     s->activePosition = 4095;
     s->inactivePosition = 0;
@@ -143,6 +143,7 @@ protected:
   VL53L0X(VPIN firstVpin, int nPins, I2CAddress i2cAddress, uint16_t onThreshold, uint16_t offThreshold, VPIN xshutPin = VPIN_NONE) {
     _firstVpin = firstVpin;
     _nPins = (nPins > 3) ? 3 : nPins;
+    _hasAnalogueNotify = true;
     _I2CAddress = i2cAddress;
     _onThreshold = onThreshold;
     _offThreshold = offThreshold;
@@ -272,6 +273,11 @@ protected:
               _value = true;
             else if (_distance > _offThreshold) 
               _value = false;
+            if (IOAnalogueWatch::hasWatch()) {
+              IOAnalogueWatch::evaluate(_firstVpin, _distance);
+              IOAnalogueWatch::evaluate(_firstVpin+1, _signal);
+              IOAnalogueWatch::evaluate(_firstVpin+2, _ambient);
+            }
           }
           // Completed. Restart scan on next loop entry.
           _nextState = STATE_INITIATESCAN;
@@ -0,0 +1,120 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IDINDEX_H
+#define IDINDEX_H
+
+#include <Arduino.h>
+
+/*
+ * IdIndex - index from a 16-bit object id (turnout, sensor or output id) to
+ * a value, normally a pointer to the object or its position in a table.
+ *
+ * The entries are held in an array sorted by id, so that lookups take a
+ * binary search, i.e. at most 9 comparisons for 500 objects.  The owning class
+ * keeps its own list (or table) in creation order for the listing commands,
+ * and uses the index only to find an object by id.  The array is extended by
+ * 'growBy' entries at a time as required.
+ */
+template <typename T>
+class IdIndex {
+public:
+  // Return the value recorded for the id, or notFound if there is none.
+  T find(uint16_t id, T notFound) const {
+    uint16_t pos = lowerBound(id);
+    if (pos < _count && _entries[pos].id == id) return _entries[pos].value;
+    return notFound;
+  }
+
+  // Record the value for the id, replacing any existing entry.  Returns false
+  // if memory allocation fails.
+  bool insert(uint16_t id, T value) {
+    uint16_t pos = lowerBound(id);
+    if (pos < _count && _entries[pos].id == id) {
+      _entries[pos].value = value;
+      return true;
+    }
+    if (_count >= _capacity && !reserve(_capacity + growBy)) return false;
+    memmove(&_entries[pos+1], &_entries[pos], (_count - pos) * sizeof(Entry));
+    _entries[pos].id = id;
+    _entries[pos].value = value;
+    _count++;
+    return true;
+  }
+
+  // Remove the entry for the id.  Returns false if there is none.
+  bool remove(uint16_t id) {
+    uint16_t pos = lowerBound(id);
+    if (pos >= _count || _entries[pos].id != id) return false;
+    _count--;
+    memmove(&_entries[pos], &_entries[pos+1], (_count - pos) * sizeof(Entry));
+    return true;
+  }
+
+  // Allocate space for the number of entries specified, e.g. before loading a
+  // known number of objects.  Returns false if memory allocation fails.
+  bool reserve(uint16_t capacity) {
+    if (capacity <= _capacity) return true;
+    Entry *newEntries = (Entry *)realloc(_entries, capacity * sizeof(Entry));
+    if (!newEntries) return false;
+    _entries = newEntries;
+    _capacity = capacity;
+    return true;
+  }
+
+  // Remove all entries and release the memory.
+  void clear() {
+    free(_entries);
+    _entries = NULL;
+    _count = _capacity = 0;
+  }
+
+  // Access to the values in id order, e.g. to renumber table positions when an
+  // object is removed from a table.
+  inline uint16_t count() const { return _count; }
+  inline uint16_t idAt(uint16_t pos) const { return _entries[pos].id; }
+  inline T &valueAt(uint16_t pos) { return _entries[pos].value; }
+
+private:
+  struct Entry {
+    uint16_t id;
+    T value;
+  };
+  static const uint8_t growBy = 8;
+  Entry *_entries = NULL;
+  uint16_t _count = 0;
+  uint16_t _capacity = 0;
+
+  // Return the position of the first entry with an id not less than the
+  // one specified (or _count if there is none).
+  uint16_t lowerBound(uint16_t id) const {
+    uint16_t low = 0, high = _count;
+    while (low < high) {
+      uint16_t mid = (low + high) / 2;
+      if (_entries[mid].id < id)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+    return low;
+  }
+};
+
+#endif
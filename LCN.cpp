@@ -59,9 +59,8 @@ void LCN::loop() {
     }
     else if (ch == 'S' || ch == 's') {
       if (Diag::LCN) DIAG(F("LCN IN %d%c"),id,(char)ch);
-      Sensor * ss = Sensor::get(id);
-      if (!ss) ss = Sensor::create(id, VPIN_NONE, 0); // impossible pin
-      ss->setState(ch == 'S');
+      if (!Sensor::exists(id)) Sensor::create(id, VPIN_NONE, 0); // impossible pin
+      Sensor::setState(id, ch == 'S');
       id = 0;
     }
     else  id = 0; // ignore any other garbage from LCN
@@ -116,11 +116,15 @@ void LiquidCrystal_I2C::clearNative() {
 }
 
 void LiquidCrystal_I2C::setRowNative(byte row) {
+  setCursorNative(0, row);
+}
+
+void LiquidCrystal_I2C::setCursorNative(uint8_t col, uint8_t row) {
   uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
   if (row >= lcdRows) {
     row = lcdRows - 1;  // we count rows starting w/0
   }
-  command(LCD_SETDDRAMADDR | (row_offsets[row]));
+  command(LCD_SETDDRAMADDR | (row_offsets[row] + col));
 }
 
 void LiquidCrystal_I2C::display() {
@@ -68,9 +68,11 @@ public:
   bool begin() override;
   void clearNative() override;
   void setRowNative(byte line) override;
+  void setCursorNative(uint8_t col, uint8_t line) override;
   size_t writeNative(uint8_t c) override;
   // I/O is synchronous, so if this is called we're not busy!
   bool isBusy() override; 
+  I2CAddress getI2CAddress() override { return _Addr; }
   
   void display();
   void noBacklight();
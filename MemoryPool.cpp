@@ -0,0 +1,107 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryPool.h"
+
+#ifdef STATIC_MEMORY_POOLS
+
+#include "DIAG.h"
+#include "IODevice.h"
+#include "Turnouts.h"
+#include "Sensors.h"
+#include "Outputs.h"
+#include "RingStream.h"
+#include "EXRAIL2.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// MemoryPool
+
+void *MemoryPool::allocate() {
+  void *block;
+  if (_freeList) {
+    block = _freeList;
+    _freeList = *(void **)block;
+  } else if (_used < _blockCount) {
+    block = _storage + _used * _blockSize;
+  } else {
+    // Pool full, use the heap.
+    if (_overflows++ == 0) DIAG(F("Memory pool full (%d blocks)"), _blockCount);
+    return calloc(1, _blockSize);
+  }
+  if (++_used > _highWater) _highWater = _used;
+  memset(block, 0, _blockSize);
+  return block;
+}
+
+void MemoryPool::release(void *block) {
+  if (!block) return;
+  if ((uint8_t *)block < _storage || (uint8_t *)block >= _storage + _blockCount * _blockSize) {
+    free(block);  // Allocated from the heap when the pool was full
+    return;
+  }
+  *(void **)block = _freeList;
+  _freeList = block;
+  _used--;
+}
+
+void MemoryPool::printUsage(const FSH *name) {
+  printUsage(name, _used, _highWater, _blockCount, _overflows);
+}
+
+void MemoryPool::printUsage(const FSH *name, uint16_t used, uint16_t highWater,
+    uint16_t capacity, uint16_t overflows) {
+  DIAG(F("Pool %S: used %d, max %d of %d, overflows %d"), name, used, highWater, capacity, overflows);
+}
+
+// List use of all the pools (<D POOLS> command).
+void MemoryPool::printAll() {
+  Turnout::pool.printUsage(F("Turnouts"));
+  Sensor::printPoolUsage();
+  Output::pool.printUsage(F("Outputs"));
+#ifndef IO_NO_HAL
+  PCA9685::servoDataPool.printUsage(F("Servos"));
+#endif
+  IONotifyCallback::pool.printUsage(F("Callbacks"));
+#ifdef EXRAIL_ACTIVE
+  LookList::arena.printUsage(F("EXRAIL lists"));
+#endif
+  RingStream::bufferArena.printUsage(F("Stream buffers"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MemoryArena
+
+void *MemoryArena::allocate(uint16_t size) {
+  uint16_t start = (_used + __BIGGEST_ALIGNMENT__ - 1) / __BIGGEST_ALIGNMENT__ * __BIGGEST_ALIGNMENT__;
+  if (start + (uint32_t)size > _size) {
+    // Arena full, use the heap.
+    if (_overflows++ == 0) DIAG(F("Memory arena full (%d bytes)"), _size);
+    return calloc(1, size);
+  }
+  _used = start + size;
+  return _storage + start;  // Storage is zeroed at startup and never reused.
+}
+
+void MemoryArena::printUsage(const FSH *name) {
+  // An arena is never released, so the use is also its high-water mark.
+  MemoryPool::printUsage(name, _used, _used, _size, _overflows);
+}
+
+#endif
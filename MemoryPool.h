@@ -0,0 +1,110 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+
+#include <Arduino.h>
+#include "defines.h"
+#include "FSH.h"
+
+/*
+ * Static memory pools, enabled by defining STATIC_MEMORY_POOLS in config.h.
+ *
+ * Objects that are otherwise allocated one at a time from the heap while the
+ * command station runs (turnouts, outputs, servo data, notification callbacks,
+ * EXRAIL lookup lists and stream buffers) are then placed in arrays of fixed
+ * size, reserved at link time, so that the memory they need is shown in the
+ * compiler's RAM summary and the heap is not fragmented by them.
+ *
+ * If a pool is full, the allocation is made from the heap instead, and counted
+ * as an overflow, so a pool that is too small does not stop the command station
+ * working.  The <D POOLS> command lists the use and high-water mark of each pool,
+ * so the sizes in config.h can be adjusted to suit the layout.
+ *
+ * Both classes have constexpr constructors, so the pools are set up before any
+ * constructor runs and may be used by objects created during static initialisation.
+ */
+
+#ifdef STATIC_MEMORY_POOLS
+
+// Round a block size up so that the blocks are aligned for any object, and
+// are big enough to hold the free list link.
+#define POOL_BLOCK_SIZE(size) \
+  ((((size) < sizeof(void *) ? sizeof(void *) : (size)) + __BIGGEST_ALIGNMENT__ - 1) \
+    / __BIGGEST_ALIGNMENT__ * __BIGGEST_ALIGNMENT__)
+
+// Declare the storage for a pool or arena of the size given.
+#define POOL_STORAGE(name, size) \
+  static uint8_t name[size] __attribute__((aligned(__BIGGEST_ALIGNMENT__)))
+
+/*
+ * MemoryPool - fixed number of equal-sized blocks, which may be released and reused.
+ */
+class MemoryPool {
+public:
+  constexpr MemoryPool(uint8_t *storage, uint16_t blockSize, uint16_t blockCount)
+    : _storage(storage), _blockSize(blockSize), _blockCount(blockCount) {}
+
+  // Return a zeroed block.
+  void *allocate();
+  // Return a block to the pool (or to the heap, if it was allocated there).
+  void release(void *block);
+  void printUsage(const FSH *name);
+
+  // List all the pools (<D POOLS> command).
+  static void printAll();
+  static void printUsage(const FSH *name, uint16_t used, uint16_t highWater,
+    uint16_t capacity, uint16_t overflows);
+
+private:
+  uint8_t *_storage;
+  uint16_t _blockSize;
+  uint16_t _blockCount;
+  uint16_t _used = 0;
+  uint16_t _highWater = 0;
+  uint16_t _overflows = 0;
+  // Blocks that have been released.  While there are none, all blocks used so
+  // far are in use, so the next unused block is at position _used.
+  void *_freeList = NULL;
+};
+
+/*
+ * MemoryArena - blocks of any size, which are kept for the life of the program
+ * (e.g. buffers created at startup).
+ */
+class MemoryArena {
+public:
+  constexpr MemoryArena(uint8_t *storage, uint16_t size)
+    : _storage(storage), _size(size) {}
+
+  // Return a zeroed block of the size given.
+  void *allocate(uint16_t size);
+  void printUsage(const FSH *name);
+
+private:
+  uint8_t *_storage;
+  uint16_t _size;
+  uint16_t _used = 0;
+  uint16_t _overflows = 0;
+};
+
+#endif
+#endif
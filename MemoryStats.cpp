@@ -0,0 +1,66 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MemoryStats.h"
+
+#ifdef MEMORY_STATS
+
+#include "DCCTimer.h"
+#include "DIAG.h"
+
+MemoryStats::Usage MemoryStats::_usage[NUM_SUBSYSTEMS];
+MemoryStats::Subsystem MemoryStats::_current = MemoryStats::OTHER;
+long MemoryStats::_lastHeapInUse = 0;
+
+MemoryStats::Subsystem MemoryStats::enter(Subsystem subsystem) {
+  long heapInUse = DCCTimer::heapInUse();
+  long change = heapInUse - _lastHeapInUse;
+  if (change != 0) {
+    Usage *usage = &_usage[_current];
+    usage->current += change;
+    if (change > 0) {
+      usage->allocations++;
+      if (usage->current > usage->peak) usage->peak = usage->current;
+    }
+    _lastHeapInUse = heapInUse;
+  }
+  Subsystem previous = _current;
+  _current = subsystem;
+  return previous;
+}
+
+void MemoryStats::printUsage(const FSH *name, Subsystem subsystem) {
+  Usage *usage = &_usage[subsystem];
+  DIAG(F("Memory %S: %l bytes, peak %l, allocated in %l scopes"),
+    name, usage->current, usage->peak, usage->allocations);
+}
+
+void MemoryStats::printAll() {
+  enter(_current);  // Bring the current subsystem up to date
+  printUsage(F("HAL"), HAL);
+  printUsage(F("EXRAIL"), EXRAIL);
+  printUsage(F("Network"), NETWORK);
+  printUsage(F("Objects"), OBJECTS);
+  printUsage(F("Other"), OTHER);
+  DIAG(F("Heap in use %l bytes, largest free block %l, minimum free %d"),
+    _lastHeapInUse, DCCTimer::largestFreeBlock(), DCCTimer::getMinimumFreeMemory());
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <Arduino.h>
+#include "defines.h"
+#include "FSH.h"
+
+/*
+ * Heap usage per subsystem, enabled by defining MEMORY_STATS in config.h.
+ *
+ * Code that may allocate or release memory on behalf of a subsystem is marked
+ * with MEMORY_SCOPE(subsystem), e.g. in a setup function or where a task or a
+ * client connection is created or deleted.  Each scope reads the heap in use
+ * twice, which may mean walking the heap, so scopes are not put in functions
+ * called on every pass of the main loop.
+ * The change in the heap in use (as counted by the heap allocator itself, see
+ * DCCTimer::heapInUse) between entering and leaving the scope is charged to the
+ * subsystem; if scopes are nested, the inner scope gets the memory allocated
+ * while it is active.  Memory allocated outside any scope (including the
+ * Arduino core and static initialisation) is charged to 'Other'.
+ *
+ * The scopes catch all allocations, whether by new or by malloc/calloc/realloc,
+ * without replacing the allocator, which the various Arduino cores don't
+ * allow to be done in a portable way.
+ *
+ * The <D MEM> command lists, for each subsystem, the bytes in use, the peak, and
+ * the number of scopes in which memory was allocated; also the total heap in use,
+ * the largest free block and the lowest free memory seen.
+ *
+ * The scopes must only be used in the main loop, not in interrupt handlers or
+ * other tasks.
+ */
+
+#ifdef MEMORY_STATS
+
+class MemoryStats {
+public:
+  enum Subsystem : uint8_t {
+    OTHER,
+    HAL,      // IODevice drivers
+    EXRAIL,   // Automation tasks and lists
+    NETWORK,  // WiFi, Ethernet and throttle connections
+    OBJECTS,  // Turnouts, sensors and outputs, and their EEPROM storage
+    NUM_SUBSYSTEMS
+  };
+  // Charge the memory allocated since the last call to the current subsystem,
+  // and make the subsystem given the current one.  Returns the previous one.
+  static Subsystem enter(Subsystem subsystem);
+  static void printAll();  // <D MEM> command
+
+private:
+  struct Usage {
+    long current;
+    long peak;
+    unsigned long allocations;
+  };
+  static Usage _usage[NUM_SUBSYSTEMS];
+  static void printUsage(const FSH *name, Subsystem subsystem);
+  static Subsystem _current;
+  static long _lastHeapInUse;
+};
+
+class MemoryScope {
+public:
+  MemoryScope(MemoryStats::Subsystem subsystem) { _previous = MemoryStats::enter(subsystem); }
+  ~MemoryScope() { MemoryStats::enter(_previous); }
+private:
+  MemoryStats::Subsystem _previous;
+};
+
+#define MEMORY_SCOPE(subsystem) MemoryScope memoryScope(MemoryStats::subsystem)
+
+#else
+
+#define MEMORY_SCOPE(subsystem)
+
+#endif
+#endif
@@ -177,6 +177,10 @@ void MotorDriver::setPower(POWERMODE mode) {
   lastPowerChange[(int)mode] = micros();
   if (mode == POWERMODE::OVERLOAD)
     globalOverloadStart = lastPowerChange[(int)mode];
+  if (mode == POWERMODE::OVERLOAD || mode == POWERMODE::OFF) {
+    // Start afresh when power comes back
+    overload.reset();
+  }
   bool on=(mode==POWERMODE::ON || mode ==POWERMODE::ALERT);
   if (on) {
     // when switching a track On, we need to check the crrentOffset with the pin OFF
@@ -458,6 +462,24 @@ void  MotorDriver::getFastPin(const FSH* type,int pin, bool input, FASTPIN & res
     // DIAG(F(" port=0x%x, inoutpin=0x%x, isinput=%d, mask=0x%x"),port, result.inout,input,result.maskHIGH);
 }
 
+// Filter a current reading (absolute value, raw ADC units) into lastCurrent,
+// and update the overload integral (see OverloadFilter).
+void MotorDriver::filterCurrent(int current) {
+  unsigned long now = micros();
+  unsigned long elapsed = now - lastCurrentSample;
+  lastCurrentSample = now;
+  lastCurrent = overload.sample(current, elapsed, tripValue);
+}
+
+bool MotorDriver::setTripCurve(uint16_t curveMs, uint16_t hardPercent, uint8_t filterShift) {
+  return overload.setCurve(curveMs, hardPercent, filterShift);
+}
+
+void MotorDriver::reportTripCurve(byte trackno) {
+  DIAG(F("TRACK %c TRIP %dmA curve %dms hard %d%% filter %d"), trackno + 'A',
+    raw2mA(getRawCurrentTripValue()), overload.curveMs(), overload.hardPercent(), overload.filterShift());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 // checkPowerOverload(useProgLimit, trackno)
 // bool useProgLimit: Trackmanager knows if this track is in prog mode or in main mode
@@ -483,8 +505,12 @@ void  MotorDriver::getFastPin(const FSH* type,int pin, bool input, FASTPIN & res
 // Transition happens if different timeouts have elapsed.
 // If only the fault pin is active, timeout is
 // POWER_SAMPLE_IGNORE_FAULT_LOW (100ms)
-// If only overcurrent is detected, timeout is
-// POWER_SAMPLE_IGNORE_CURRENT (100ms)
+// If only overcurrent is detected, the time depends on the
+// size of the overload (see filterCurrent() and setTripCurve()).
+// It is at most the trip curve time, by default
+// POWER_SAMPLE_IGNORE_CURRENT (100ms), and less for an overload
+// of more than twice the trip current; above the hard trip
+// current it is immediate.
 // If fault pin and overcurrent are active, timeout is
 // POWER_SAMPLE_IGNORE_FAULT_HIGH (5ms)
 // Transition to OVERLOAD turns off power to the affected
@@ -578,10 +604,11 @@ void MotorDriver::checkPowerOverload(bool useProgLimit, byte trackno) {
     }
     if (checkCurrent(useProgLimit)) {
       lastBadSample = now;
-      if (mslpc < POWER_SAMPLE_IGNORE_CURRENT) {
+      unsigned long timeout = overload.curveMs() * 1000UL;
+      if (!overload.tripped(lastCurrent, tripValue, ADCee::ADCmax() - senseOffset, mslpc)) {
 	if (powerModeChange) {
 	  unsigned int mA=raw2mA(lastCurrent);
-	  DIAG(F("TRACK %c CURRENT (%M ignore) %dmA"), trackno + 'A', POWER_SAMPLE_IGNORE_CURRENT, mA);
+	  DIAG(F("TRACK %c CURRENT (%M ignore) %dmA"), trackno + 'A', timeout, mA);
 	}
 	break;
       }
@@ -26,6 +26,7 @@
 #include "FSH.h"
 #include "IODevice.h"
 #include "DCCTimer.h"
+#include "OverloadFilter.h"
 
 // use powers of two so we can do logical and/or on the track modes in if clauses.
 enum TRACK_MODE : byte {TRACK_MODE_NONE = 1, TRACK_MODE_MAIN = 2, TRACK_MODE_PROG = 4,
@@ -152,6 +153,12 @@ class MotorDriver {
 	pinMode(signalPin, INPUT);
     };
     inline pinpair getSignalPin() { return pinpair(signalPin,signalPin2); };
+    // Signal pin 0 or 1 (the inverted one, if any), for TrackManager to set
+    // the signals of several tracks together.  NULL if there is no such pin.
+    inline const FASTPIN * getFastSignalPin(byte n) {
+      if (n==0) return &fastSignalPin;
+      return dualSignal ? &fastSignalPin2 : NULL;
+    };
     void setDCSignal(byte speedByte);
     void throttleInrush(bool on);
     inline void detachDCSignal() {
@@ -195,6 +202,12 @@ class MotorDriver {
       isProgTrack = on;
     }
     void checkPowerOverload(bool useProgLimit, byte trackno);
+    // Overload trip curve: time to trip at twice the trip current (an I squared t
+    // curve, so the time is shorter for larger overloads, and also the longest time
+    // any overload lasts), current for an immediate trip as a percentage of the
+    // trip current, and the strength of the filter on the current readings (0 for none).
+    bool setTripCurve(uint16_t curveMs, uint16_t hardPercent, uint8_t filterShift);
+    void reportTripCurve(byte trackno);
     inline void setTrackLetter(char c) {
       trackLetter = c;
     };
@@ -225,14 +238,16 @@ class MotorDriver {
     inline void  getFastPin(const FSH* type,int pin, FASTPIN & result) {
 	getFastPin(type, pin, 0, result);
     };
-    // side effect sets lastCurrent and tripValue
+    // side effect sets lastCurrent (filtered) and tripValue, and updates the overload integral
     inline bool checkCurrent(bool useProgLimit) {
       tripValue= useProgLimit?progTripValue:getRawCurrentTripValue();
-      lastCurrent = getCurrentRaw();
-      if (lastCurrent < 0)
-	lastCurrent = -lastCurrent;
+      int current = getCurrentRaw();
+      if (current < 0)
+	current = -current;
+      filterCurrent(current);
       return lastCurrent >= tripValue;
     };
+    void filterCurrent(int current);
     // side effect sets lastCurrent
     inline bool checkFault() {
       lastCurrent = getCurrentRaw();
@@ -289,6 +304,10 @@ class MotorDriver {
     // Upper limit for retry period
     static const unsigned long POWER_SAMPLE_RETRY_MAX =      10000000UL;
     
+    // Current filter and overload trip curve (see setTripCurve).
+    OverloadFilter overload;
+    unsigned long lastCurrentSample = 0;  // timestamp in microseconds
+
     // Trip current for programming track, 250mA. Change only if you really
     // need to be non-NMRA-compliant because of decoders that are not either.
     static const int TRIP_CURRENT_PROG=250;
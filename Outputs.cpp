@@ -91,6 +91,7 @@ the state of any outputs being monitored or controlled by a separate interface o
 #endif
 #include "StringFormatter.h"
 #include "IODevice.h"
+#include "MemoryStats.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 // Static function to print all output states to stream in the form "<Y id state>"
@@ -111,7 +112,7 @@ void  Output::activate(uint16_t s){
 #ifndef DISABLE_EEPROM
   // Update EEPROM if output has been stored.    
   if(EEStore::eeStore->data.nOutputs > 0 && num > 0)
-    EEPROM.put(num, data.oStatus);
+    EEStore::saveState(EEStore::STATE_OUTPUT, data.id, data.active);
 #endif
 }
 
@@ -120,9 +121,7 @@ void  Output::activate(uint16_t s){
 //   Return NULL if not found.
 
 Output* Output::get(uint16_t n){
-  Output *tt;
-  for(tt=firstOutput;tt!=NULL && tt->data.id!=n;tt=tt->nextOutput);
-  return(tt);
+  return outputIndex.find(n, NULL);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -130,6 +129,7 @@ Output* Output::get(uint16_t n){
 //   Return false if not found.
 
 bool Output::remove(uint16_t n){
+  MEMORY_SCOPE(OBJECTS);
   Output *tt,*pp=NULL;
 
   for(tt=firstOutput;tt!=NULL && tt->data.id!=n;pp=tt,tt=tt->nextOutput);
@@ -140,8 +140,15 @@ bool Output::remove(uint16_t n){
     firstOutput=tt->nextOutput;
   else
     pp->nextOutput=tt->nextOutput;
+  if(tt==lastOutput)
+    lastOutput=pp;
+  outputIndex.remove(n);
 
+#ifdef STATIC_MEMORY_POOLS
+  pool.release(tt);
+#else
   free(tt);
+#endif
 
   return true;
   }
@@ -153,15 +160,19 @@ void Output::load(){
   struct OutputData data;
   Output *tt;
 
+  outputIndex.reserve(outputIndex.count() + EEStore::eeStore->data.nOutputs);
   for(uint16_t i=0;i<EEStore::eeStore->data.nOutputs;i++){
-    EEPROM.get(EEStore::pointer(),data);
+    int eepromAddress = EEStore::pointer();
+    EEStore::read(data);
+    // Latest state may be in the EEStore journal.
+    data.active = EEStore::restoredState(EEStore::STATE_OUTPUT, data.id, data.active);
     // Create new object, set current state to default or to saved state from eeprom.
     tt=create(data.id, data.pin, data.flags);
+    if (!tt) continue;  // Out of memory, skip the record
     uint8_t state = data.setDefault ? data.defaultValue : data.active;
     tt->activate(state);
 
-    if (tt) tt->num=EEStore::pointer() + offsetof(OutputData, oStatus); // Save pointer to flags within EEPROM
-    EEStore::advance(sizeof(tt->data));
+    tt->num=eepromAddress + offsetof(OutputData, oStatus); // Save pointer to flags within EEPROM
   }
 }
 
@@ -175,14 +186,34 @@ void Output::store(){
   EEStore::eeStore->data.nOutputs=0;
 
   while(tt!=NULL){
-    EEPROM.put(EEStore::pointer(),tt->data);
     tt->num=EEStore::pointer() + offsetof(OutputData, oStatus); // Save pointer to flags within EEPROM
-    EEStore::advance(sizeof(tt->data));
+    EEStore::write(tt->data);
     tt=tt->nextOutput;
     EEStore::eeStore->data.nOutputs++;
   }
 
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// Static function to find, for the EEStore journal snapshot, the next saved
+// Output from position 'index' in the list whose state differs from the state
+// in its EEPROM definition.  Returns false if there are no more.
+bool Output::nextChangedState(uint16_t &index, uint16_t &id, uint8_t &state){
+  uint16_t n=0;
+  for (Output *tt=firstOutput; tt!=NULL; tt=tt->nextOutput, n++) {
+    if (n < index || tt->num == 0) continue;
+    struct OutputData data;
+    data.oStatus = EEPROM.read(tt->num);
+    if (data.active != tt->data.active) {
+      index = n+1;
+      id = tt->data.id;
+      state = tt->data.active;
+      return true;
+    }
+  }
+  index = n;
+  return false;
+}
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -191,22 +222,34 @@ void Output::store(){
 //   and 1 if called from the <Z> command processing.
 
 Output *Output::create(uint16_t id, VPIN pin, int iFlag, int v){
+  MEMORY_SCOPE(OBJECTS);
   Output *tt;
 
   if (pin > VPIN_MAX) return NULL;
   
-  if(firstOutput==NULL){
-    firstOutput=(Output *)calloc(1,sizeof(Output));
-    tt=firstOutput;
-  } else if((tt=get(id))==NULL){
-    tt=firstOutput;
-    while(tt->nextOutput!=NULL)
-      tt=tt->nextOutput;
-    tt->nextOutput=(Output *)calloc(1,sizeof(Output));
-    tt=tt->nextOutput;
+  if((tt=get(id))==NULL){
+    // New output, added to the end of the list and to the index.
+#ifdef STATIC_MEMORY_POOLS
+    tt=(Output *)pool.allocate();
+#else
+    tt=(Output *)calloc(1,sizeof(Output));
+#endif
+    if(tt==NULL) return tt;
+    if(!outputIndex.insert(id, tt)){
+#ifdef STATIC_MEMORY_POOLS
+      pool.release(tt);
+#else
+      free(tt);
+#endif
+      return NULL;
+    }
+    if(firstOutput==NULL)
+      firstOutput=tt;
+    else
+      lastOutput->nextOutput=tt;
+    lastOutput=tt;
   }
 
-  if(tt==NULL) return tt;
   tt->num = 0; // make sure new object doesn't get written to EEPROM until store() command
   tt->data.id=id;
   tt->data.pin=pin;
@@ -227,3 +270,9 @@ Output *Output::create(uint16_t id, VPIN pin, int iFlag, int v){
 ///////////////////////////////////////////////////////////////////////////////
 
 Output *Output::firstOutput=NULL;
+Output *Output::lastOutput=NULL;
+IdIndex<Output *> Output::outputIndex;
+#ifdef STATIC_MEMORY_POOLS
+POOL_STORAGE(outputPoolStorage, POOL_BLOCK_SIZE(sizeof(Output)) * OUTPUT_POOL_SIZE);
+MemoryPool Output::pool(outputPoolStorage, POOL_BLOCK_SIZE(sizeof(Output)), OUTPUT_POOL_SIZE);
+#endif
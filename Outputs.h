@@ -24,6 +24,8 @@
 
 #include <Arduino.h>
 #include "IODevice.h"
+#include "IdIndex.h"
+#include "MemoryPool.h"
 
 struct OutputData {
   union {
@@ -54,14 +56,20 @@ public:
 #ifndef DISABLE_EEPROM
   static void load();
   static void store();
+  static bool nextChangedState(uint16_t &index, uint16_t &id, uint8_t &state);
 #endif
   static Output *create(uint16_t, VPIN, int, int=0);
   static Output *firstOutput;
   struct OutputData data;
   Output *nextOutput;
   static void printAll(Print *);
+#ifdef STATIC_MEMORY_POOLS
+  static MemoryPool pool;
+#endif
 private:
   uint16_t num;  // EEPROM address of oStatus in OutputData struct, or zero if not stored.
+  static Output *lastOutput;
+  static IdIndex<Output *> outputIndex;  // For lookup by id
   
 }; // Output
   
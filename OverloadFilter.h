@@ -0,0 +1,122 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OVERLOADFILTER_H
+#define OVERLOADFILTER_H
+
+#include <stdint.h>
+
+/*
+ * Current filter and overload trip curve of a track, in integer arithmetic.
+ *
+ * Each reading (absolute value, raw ADC units) is passed through a first order
+ * IIR filter in fixed point: it moves the filtered value by 1/2^filterShift of
+ * the difference.
+ *
+ * An overload integral is then updated from the filtered current, as a
+ * multiple of the trip current: while the current is above the trip current
+ * the excess of its square over 1 is added, times the time since the last
+ * reading, and while it is below, the shortfall is subtracted.  So a current
+ * of twice the trip value (excess 3) trips after curveMs, and a larger
+ * overload trips sooner.  A smaller overload would take longer, but no
+ * overload is allowed to last longer than curveMs.  Above the hard trip
+ * current the trip is immediate.
+ *
+ * Used by MotorDriver.  There are no Arduino dependencies, so that the trip
+ * times can be checked on a host by replaying current traces (see
+ * tests/overload_replay.cpp).
+ */
+
+class OverloadFilter {
+public:
+  static const uint16_t DEFAULT_CURVE_MS = 100;  // MotorDriver::POWER_SAMPLE_IGNORE_CURRENT
+  static const uint16_t MAX_CURVE_MS = 10000;
+  static const uint16_t DEFAULT_HARD_PERCENT = 400;
+  static const uint8_t DEFAULT_FILTER_SHIFT = 2;
+  static const unsigned long MAX_ELAPSED_MICROS = 50000UL;  // e.g. first reading after power on
+
+  // Time to trip at twice the trip current (and the longest time any overload
+  // lasts), current for an immediate trip as a percentage of the trip current,
+  // and the strength of the filter (0 for none).  Returns false if out of range.
+  bool setCurve(uint16_t curveMs, uint16_t hardPercent, uint8_t filterShift) {
+    if (curveMs == 0 || curveMs > MAX_CURVE_MS || hardPercent <= 100 || filterShift > 8)
+      return false;
+    _curveMs = curveMs;
+    _hardPercent = hardPercent;
+    _filterShift = filterShift;
+    return true;
+  }
+  uint16_t curveMs() { return _curveMs; }
+  uint16_t hardPercent() { return _hardPercent; }
+  uint8_t filterShift() { return _filterShift; }
+
+  // Start afresh, e.g. when power comes back.
+  void reset() {
+    _filtered = 0;
+    _integral = 0;
+  }
+
+  // Filter a reading taken 'elapsedMicros' after the previous one, and update
+  // the overload integral.  Returns the filtered current.
+  int sample(int current, unsigned long elapsedMicros, int tripValue) {
+    _filtered += (((int32_t)current << 8) - _filtered) >> _filterShift;
+    int filtered = (_filtered + 128) >> 8;
+    if (elapsedMicros > MAX_ELAPSED_MICROS) elapsedMicros = MAX_ELAPSED_MICROS;
+    if (tripValue <= 0) return filtered;
+
+    // Ratio of current to trip current with 8 fractional bits, and its square with 16.
+    uint32_t ratio = ((uint32_t)filtered << 8) / tripValue;
+    if (ratio > 4096) ratio = 4096;  // 16 times trip current, the hard trip is lower
+    uint32_t ratioSquared = ratio * ratio;
+    // Units of the integral are 1/256 times 16us.
+    if (ratioSquared >= 65536UL) {
+      uint32_t increment = ((ratioSquared - 65536UL) >> 8) * elapsedMicros >> 4;
+      _integral = (_integral > 0xFFFFFFFFUL - increment) ? 0xFFFFFFFFUL : _integral + increment;
+    } else {
+      uint32_t decrement = ((65536UL - ratioSquared) >> 8) * elapsedMicros >> 4;
+      _integral = (_integral > decrement) ? _integral - decrement : 0;
+    }
+    return filtered;
+  }
+
+  // True if a filtered current over the trip current, which has been over it
+  // for 'overMicros', must be switched off.  The hard trip current is limited
+  // to just below 'maxReading', the highest current the ADC can read, so that
+  // it can be reached.
+  bool tripped(int filtered, int tripValue, int maxReading, unsigned long overMicros) {
+    if (overMicros >= _curveMs * 1000UL) return true;
+    int32_t hardLimit = (int32_t)tripValue * _hardPercent / 100;
+    int32_t saturation = maxReading - maxReading / 16;
+    if (hardLimit > saturation) hardLimit = saturation;
+    if (hardLimit < tripValue) hardLimit = tripValue;
+    if (filtered >= hardLimit) return true;
+    // 3 (excess at twice trip current) * 256 * 1000us / 16us per ms
+    return _integral >= (uint32_t)_curveMs * 48000UL;
+  }
+
+private:
+  uint16_t _curveMs = DEFAULT_CURVE_MS;
+  uint16_t _hardPercent = DEFAULT_HARD_PERCENT;
+  uint8_t _filterShift = DEFAULT_FILTER_SHIFT;
+  int32_t _filtered = 0;   // Filtered current, 8 fractional bits
+  uint32_t _integral = 0;  // Overload in current squared times time
+};
+
+#endif
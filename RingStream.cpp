@@ -29,10 +29,19 @@
 
 const byte FLASH_INSERT_MARKER=0xff;
 
+#ifdef STATIC_MEMORY_POOLS
+POOL_STORAGE(bufferArenaStorage, RINGSTREAM_POOL_SIZE);
+MemoryArena RingStream::bufferArena(bufferArenaStorage, RINGSTREAM_POOL_SIZE);
+#endif
+
 RingStream::RingStream( const uint16_t len)
 {
   _len=len;
+#ifdef STATIC_MEMORY_POOLS
+  _buffer=(byte *)bufferArena.allocate(len);
+#else
   _buffer=new byte[len];
+#endif
   _pos_write=0;
   _pos_read=0;
   _buffer[0]=0;
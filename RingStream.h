@@ -22,6 +22,7 @@
 
 #include <Arduino.h>
 #include "FSH.h"
+#include "MemoryPool.h"
   
 class RingStream : public Print {
 
@@ -53,6 +54,9 @@ class RingStream : public Print {
       return _buffer[_pos_read];
     };
     static const byte NO_CLIENT=255;
+#ifdef STATIC_MEMORY_POOLS
+    static MemoryArena bufferArena;
+#endif
  private:
    int _len;
    int _pos_write;
@@ -221,11 +221,16 @@ void SSD1306AsciiWire::clearNative() {
 
 // Set cursor position (by text line)
 void SSD1306AsciiWire::setRowNative(uint8_t line) {
-  // Calculate pixel position from line number
+  setCursorNative(0, line);
+}
+
+// Set cursor position (by character column and text line)
+void SSD1306AsciiWire::setCursorNative(uint8_t col, uint8_t line) {
+  // Calculate pixel position from line and column numbers
   uint8_t row = line*8;
   if (row < m_displayHeight) {
     m_row = row;
-    m_col = m_colOffset;
+    m_col = m_colOffset + col*fontWidth;
     // Before using buffer, wait for last request to complete
     requestBlock.wait();
     // Build output buffer for I2C
@@ -241,6 +246,41 @@ void SSD1306AsciiWire::setRowNative(uint8_t line) {
 
 // Write a character to the OLED
 size_t SSD1306AsciiWire::writeNative(uint8_t ch) {
+  // Before using buffer, wait for last request to complete
+  requestBlock.wait();
+  // Build output buffer for I2C
+  outputBuffer[0] = 0x40;     // set SSD1306 controller to data mode
+  uint8_t len = renderChar(ch, &outputBuffer[1]);
+  if (len == 0) return 0;
+
+  // Write the data to I2C display
+  I2CManager.write(m_i2cAddr, outputBuffer, len+1, &requestBlock);
+  return 1;
+}
+
+// Write a run of characters to the OLED.  The pixel columns for up to 
+// charsPerTransmission characters are sent in one I2C transmission, and the
+// number of characters sent is returned.
+uint8_t SSD1306AsciiWire::writeNative(const char *text, uint8_t length) {
+  if (length > charsPerTransmission) length = charsPerTransmission;
+  // Before using buffer, wait for last request to complete
+  requestBlock.wait();
+  // Build output buffer for I2C
+  outputBuffer[0] = 0x40;     // set SSD1306 controller to data mode
+  uint8_t bufferPos = 1;
+  for (uint8_t i = 0; i < length; i++)
+    bufferPos += renderChar(text[i], &outputBuffer[bufferPos]);
+
+  // Write the data to I2C display
+  if (bufferPos > 1)
+    I2CManager.write(m_i2cAddr, outputBuffer, bufferPos, &requestBlock);
+  return length;
+}
+
+// Copy the pixel columns for a character from the font into the buffer, and 
+// advance the cursor.  Returns the number of pixel columns, or 0 if the 
+// character can't be displayed.
+uint8_t SSD1306AsciiWire::renderChar(uint8_t ch, uint8_t *buffer) {
   const uint8_t* base = m_font;
 
 #if defined(NOLOWERCASE)
@@ -260,20 +300,12 @@ size_t SSD1306AsciiWire::writeNative(uint8_t ch) {
 
   ch -= m_fontFirstChar;
   base += fontWidth * ch;
-  // Before using buffer, wait for last request to complete
-  requestBlock.wait();
-  // Build output buffer for I2C
-  outputBuffer[0] = 0x40;     // set SSD1306 controller to data mode
-  uint8_t bufferPos = 1;
   // Copy character pixel columns
   for (uint8_t i = 0; i < fontWidth; i++) {
-    if (m_col++ < m_displayWidth) 
-      outputBuffer[bufferPos++] = GETFLASH(base++);
+    buffer[i] = GETFLASH(base++);
   }
-
-  // Write the data to I2C display
-  I2CManager.write(m_i2cAddr, outputBuffer, bufferPos, &requestBlock);
-  return 1;
+  m_col += fontWidth;
+  return fontWidth;
 }
 
 
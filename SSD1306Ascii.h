@@ -51,11 +51,18 @@ class SSD1306AsciiWire : public DisplayDevice {
 
   // Set cursor to start of specified text line
   void setRowNative(byte line) override;
+
+  // Set cursor to a character position within a text line
+  void setCursorNative(uint8_t col, uint8_t line) override;
   
   // Write one character to OLED
   size_t writeNative(uint8_t c) override;
 
+  // Write a run of characters to OLED, several per I2C transmission
+  uint8_t writeNative(const char *text, uint8_t length) override;
+
   bool isBusy() override { return requestBlock.isBusy(); }
+  I2CAddress getI2CAddress() override { return m_i2cAddr; }
   uint16_t getNumCols() { return m_charsPerRow; }
   uint16_t getNumRows() { return m_charsPerColumn; }
 
@@ -84,11 +91,15 @@ class SSD1306AsciiWire : public DisplayDevice {
   static const uint8_t fontHeight = 8;
   static const uint8_t m_fontFirstChar = 0x20;
   static const uint8_t m_fontCharCount;
+  // Characters sent per I2C transmission, limited by the 32-byte buffer in Wire
+  static const uint8_t charsPerTransmission = 5;
 
   I2CAddress m_i2cAddr = 0;
 
   I2CRB requestBlock;
-  uint8_t outputBuffer[fontWidth+1];
+  uint8_t outputBuffer[fontWidth*charsPerTransmission+1];
+
+  uint8_t renderChar(uint8_t ch, uint8_t *buffer);
 
   static const uint8_t blankPixels[];
 
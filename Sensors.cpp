@@ -71,6 +71,7 @@ decide to ignore the <q ID> return and only react to <Q ID> triggers.
 #include "StringFormatter.h"
 #include "CommandDistributor.h"
 #include "Sensors.h"
+#include "MemoryStats.h"
 #ifndef DISABLE_EEPROM
 #include "EEStore.h"
 #endif
@@ -78,16 +79,20 @@ decide to ignore the <q ID> return and only react to <Q ID> triggers.
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// checks a number of defined sensors per entry and prints _changed_ sensor state
-// to stream unless stream is NULL in which case only internal
-// state is updated. Then advances to next sensor which will
-// be checked at next invocation.  Each cycle of reading all sensors will
-// be initiated no more frequently than the time set by 'cycleInterval' microseconds.
+// Processes sensor changes and prints _changed_ sensor states to all clients.
 //
-// The list of sensors is divided such that the first part of the list
-// contains sensors that support change notification via callback, and the second
-// part of the list contains sensors that require cyclic polling.  The start of the
-// second part of the list is determined from by the 'firstPollSensor' pointer.
+// When a sensor's input state changes (detected by polling, by HAL change
+// notification, or set by setState() for sources such as LCN), the sensor is placed
+// on a small queue of pending changes, with the time of the change.  The change is 
+// reported once the input has remained in the new state for the sensor's debounce 
+// time, or dropped if the input returns to the reported state first.  So the 
+// reporting latency does not depend on the number of sensors defined, and sensors 
+// whose inputs are stable need no processing.
+//
+// Sensors that require cyclic polling are read a number per entry, and each scan 
+// of the table will be initiated no more frequently than the time set by 
+// 'cycleInterval' microseconds.  Other sensors are skipped with a single test of
+// their state bits.
 ///////////////////////////////////////////////////////////////////////////////
 
 void Sensor::checkAll(){
@@ -96,81 +101,180 @@ void Sensor::checkAll(){
 #ifdef USE_NOTIFY
   // Register the event handler ONCE!
   if (!inputChangeCallbackRegistered)
-    IONotifyCallback::add(inputChangeCallback);
+    IONotifyCallback::addPort(inputChangeCallback);
   inputChangeCallbackRegistered = true;
 #endif
 
-  if (firstSensor == NULL) return;  // No sensors to be scanned
-  if (readingSensor == NULL) { 
-    // Not currently scanning sensor list
-    unsigned long thisTime = micros();
+  if (count == 0) return;  // No sensors to be scanned
+
+  if (pendingOverflow) recoverPending();
+  if (pendingCount > 0) processPending();
+
+  unsigned long thisTime = micros();
+  if (readingSlot >= count) { 
+    // Not currently scanning sensor table
     if (thisTime - lastReadCycle >= cycleInterval) {
       // Required time elapsed since last read cycle started,
-      // so initiate new scan through the sensor list
-      readingSensor = firstSensor;
+      // so initiate new scan through the sensor table
+      readingSlot = 0;
       lastReadCycle = thisTime;
     }
   }
 
-  // Loop until either end of list is encountered or we pause for some reason
-  bool pause = false;
-  while (readingSensor != NULL && !pause) {
-
-    // Where the sensor is attached to a pin, read pin status.  For sources such as LCN,
-    // which don't have an input pin to read, the LCN class calls setState() to update inputState when
-    // a message is received.  The IODevice::read() call returns 1 for active pins (0v) and 0 for inactive (5v).
-    // Also, on HAL drivers that support change notifications, the driver calls the notification callback
-    // routine when an input signal change is detected, and this updates the inputState directly,
-    // so these inputs don't need to be polled here.
-    VPIN pin = readingSensor->data.pin;
-    if (readingSensor->pollingRequired && pin != VPIN_NONE)
-      readingSensor->inputState = IODevice::read(pin);
-
-    // Check if changed since last time, and process changes.
-    if (readingSensor->inputState == readingSensor->active) {
-      // no change
-      readingSensor->latchDelay = minReadCount; // Reset counter
-    } else if (readingSensor->latchDelay > 0) {
-      // change detected, but first decrement delay
-      readingSensor->latchDelay--;
-    } else { 
-      // change validated, act on it.
-      readingSensor->active = readingSensor->inputState;
-      readingSensor->latchDelay = minReadCount;  // Reset counter
-      
-      CommandDistributor::broadcastSensor(readingSensor->data.snum,readingSensor->active);
-      pause = true;  // Don't check any more sensors on this entry
-    }
+  // Loop until either end of table is encountered or we have read enough sensors
+  for ( ; readingSlot < count && sensorCount < 16; readingSlot++) {
+    if (!(states[readingSlot] & STATE_POLL)) continue;
 
-    // Move to next sensor in list.
-    readingSensor = readingSensor->nextSensor;
+    // Read pin status.  The IODevice::read() call returns 1 for active pins (0v) and 0 for inactive (5v).
+    setInputState(readingSlot, IODevice::read(pins[readingSlot]));
 
-    // Currently process max of 16 sensors per entry.
+    // Currently process max of 16 polled sensors per entry.
     // Performance measurements taken during development indicate that, with 128 sensors configured
     // on 8x 16-pin MCP23017 GPIO expanders with polling (no change notification), all inputs can be read from the devices
     // within 1.4ms (400Mhz I2C bus speed), and a full cycle of checking 128 sensors for changes takes under a millisecond.
     sensorCount++;
-    if (sensorCount >= 16) pause = true;
   }
 
 } // Sensor::checkAll
 
+///////////////////////////////////////////////////////////////////////////////
+// Record a sensor's latest input state, and start (or restart) its debounce 
+// time if it has changed.
+
+void Sensor::setInputState(uint16_t slot, bool state) {
+  uint8_t oldState = states[slot];
+  if (!(oldState & STATE_INPUT) == !state) return;  // Unchanged
+  states[slot] = oldState ^ STATE_INPUT;
+  queuePending(slot);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pending change queue.  A sensor is added when its input state changes, and 
+// removed once the change has been reported, or the input has returned to the 
+// reported state.  If a sensor is already queued, its debounce time restarts.
+
+void Sensor::queuePending(uint16_t slot) {
+  uint16_t now = millis();
+  uint8_t state = states[slot];
+  if (state & STATE_QUEUED) {
+    for (uint8_t n = 0, position = pendingFirst; n < pendingCount; n++) {
+      if (pendingQueue[position] == slot) {
+        pendingSince[position] = now;
+        return;
+      }
+      if (++position >= pendingQueueSize) position = 0;
+    }
+    return;
+  }
+  if (!(state & STATE_INPUT) == !(state & STATE_ACTIVE)) return;
+  if (pendingCount >= pendingQueueSize) {
+    // No room; recoverPending() will find it when there is.
+    pendingOverflow = true;
+    return;
+  }
+  uint8_t position = pendingFirst + pendingCount;
+  if (position >= pendingQueueSize) position -= pendingQueueSize;
+  pendingQueue[position] = slot;
+  pendingSince[position] = now;
+  pendingCount++;
+  states[slot] = state | STATE_QUEUED;
+}
+
+// Report the changes which have persisted for their debounce time, and drop the
+// ones which have reverted.  Each entry is taken from the front of the queue and, 
+// if still pending, put back at the end.
+void Sensor::processPending() {
+  uint16_t now = millis();
+  for (uint8_t remaining = pendingCount, kept = 0; remaining > 0; remaining--) {
+    uint16_t slot = pendingQueue[pendingFirst];
+    uint16_t since = pendingSince[pendingFirst];
+    if (++pendingFirst >= pendingQueueSize) pendingFirst = 0;
+    uint8_t state = states[slot];
+    if (!(state & STATE_INPUT) == !(state & STATE_ACTIVE)) {
+      // Input has returned to the reported state, so no change.
+      states[slot] = state & ~STATE_QUEUED;
+      pendingCount--;
+    } else if ((uint16_t)(now - since) >= debounceTimes[slot]) {
+      // Change validated, act on it.
+      state ^= STATE_ACTIVE;
+      states[slot] = state & ~STATE_QUEUED;
+      pendingCount--;
+      CommandDistributor::broadcastSensor(ids[slot], state & STATE_ACTIVE);
+    } else {
+      // Still waiting.
+      uint8_t position = (pendingFirst + remaining - 1 + kept) % pendingQueueSize;
+      pendingQueue[position] = slot;
+      pendingSince[position] = since;
+      kept++;
+    }
+  }
+}
+
+// After a queue overflow, scan the table for unreported changes.  Their debounce
+// time starts now.
+void Sensor::recoverPending() {
+  pendingOverflow = false;
+  for (uint16_t slot = 0; slot < count; slot++)
+    if (!(states[slot] & STATE_QUEUED)) queuePending(slot);
+}
 
 #ifdef USE_NOTIFY
-// Callback from HAL (IODevice class) when a digital input change is recognised.
-// Updates the inputState field, which is subsequently scanned for changes in the checkAll 
-// method.  Ideally the <Q>/<q> message should be sent from here, instead of waiting for
-// the checkAll method, but the output stream is not available at this point.
-void Sensor::inputChangeCallback(VPIN vpin, int state) {
-  Sensor *tt;
-  // This bit is not ideal since it has, potentially, to look through the entire list of
-  // sensors to find the one that has changed.  Ideally this should be improved somehow.
-  for (tt=firstSensor; tt!=NULL ; tt=tt->nextSensor) {
-    if (tt->data.pin == vpin) break;
+// Callback from HAL (IODevice class) when digital input changes are recognised on a port.
+// Bit n of changedMask/newStates relates to VPIN firstVpin+n.
+// Updates the input state, so that the change is debounced and reported by the 
+// checkAll method.
+void Sensor::inputChangeCallback(VPIN firstVpin, uint32_t changedMask, uint32_t newStates) {
+  // The VPIN index is sorted, so the sensors on the port are found by a binary search
+  // for the first one, followed by a scan which stops after the port's last pin.
+  for (uint16_t i=vpinIndexLowerBound(firstVpin); i<vpinIndexCount; i++) {
+    uint16_t slot = vpinIndex[i];
+    uint16_t bit = pins[slot] - firstVpin;
+    if (bit >= 32) break;  // Beyond the port
+    if (bitRead(changedMask, bit))
+      setInputState(slot, bitRead(newStates, bit));
+  }
+}
+
+// Return the position of the first entry in the VPIN index with a VPIN not less than 
+// the one specified (or vpinIndexCount if there is none).
+uint16_t Sensor::vpinIndexLowerBound(VPIN vpin) {
+  uint16_t low = 0, high = vpinIndexCount;
+  while (low < high) {
+    uint16_t mid = (low + high) / 2;
+    if (pins[vpinIndex[mid]] < vpin) 
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+// Insert a sensor into the VPIN index, keeping it sorted.  Returns false if 
+// memory allocation fails.
+bool Sensor::addToVpinIndex(uint16_t slot) {
+  if (vpinIndexCount >= vpinIndexSize) {
+    uint16_t *newIndex = (uint16_t *)realloc(vpinIndex, (vpinIndexSize + growBy) * sizeof(uint16_t));
+    if (!newIndex) return false;
+    vpinIndex = newIndex;
+    vpinIndexSize += growBy;
   }
-  if (tt != NULL) { // Sensor found
-    tt->inputState = (state != 0); 
+  uint16_t pos = vpinIndexLowerBound(pins[slot]);
+  memmove(&vpinIndex[pos+1], &vpinIndex[pos], (vpinIndexCount - pos) * sizeof(uint16_t));
+  vpinIndex[pos] = slot;
+  vpinIndexCount++;
+  return true;
+}
+
+// Remove a sensor from the VPIN index (if present), and renumber the slots 
+// above it, which move down by one when the sensor is removed from the table.
+void Sensor::removeFromVpinIndex(uint16_t slot) {
+  uint16_t j = 0;
+  for (uint16_t i=0; i<vpinIndexCount; i++) {
+    uint16_t s = vpinIndex[i];
+    if (s == slot) continue;
+    vpinIndex[j++] = (s > slot) ? s-1 : s;
   }
+  vpinIndexCount = j;
 }
 #endif
 
@@ -183,96 +287,180 @@ void Sensor::inputChangeCallback(VPIN vpin, int state) {
 void Sensor::printAll(Print *stream){
 
   if (stream != NULL) {
-    for(Sensor * tt=firstSensor;tt!=NULL;tt=tt->nextSensor){
-      StringFormatter::send(stream, F("<%c %d>\n"), tt->active ? 'Q' : 'q', tt->data.snum);
+    for (uint16_t slot=0; slot<count; slot++) {
+      StringFormatter::send(stream, F("<%c %d>\n"), (states[slot] & STATE_ACTIVE) ? 'Q' : 'q', ids[slot]);
     }
   } // loop over all sensors
 } // Sensor::printAll
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// prints all sensor definitions to stream, returns false if there are none
+//
+///////////////////////////////////////////////////////////////////////////////
+
+bool Sensor::printDefinitions(Print *stream){
+  if (count == 0) return false;
+  for (uint16_t slot=0; slot<count; slot++) {
+    StringFormatter::send(stream, F("<Q %d %d %d>\n"), ids[slot], pins[slot], 
+      (states[slot] & STATE_PULLUP) ? 1 : 0);
+  }
+  return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Static Function to create/find Sensor object.
 
-Sensor *Sensor::create(int snum, VPIN pin, int pullUp){
-  Sensor *tt;
+bool Sensor::create(int snum, VPIN pin, int pullUp, uint16_t debounceMs){
+  MEMORY_SCOPE(OBJECTS);
 
-  if (pin > VPIN_MAX && pin != VPIN_NONE) return NULL;
+  if (pin > VPIN_MAX && pin != VPIN_NONE) return false;
 
-  remove(snum);  // Unlink and free any existing sensor with the same id, before creating the new one.
+  remove(snum);  // Remove any existing sensor with the same id, before creating the new one.
 
-  tt = (Sensor *)calloc(1,sizeof(Sensor));
-  if (!tt) return tt;     // memory allocation failure
+  if (count >= capacity && !grow(capacity + growBy)) return false;  // memory allocation failure
 
+  uint16_t slot = count;
+  if (!slotIndex.insert((int16_t)snum, slot)) return false;  // memory allocation failure
+  ids[slot] = snum;
+  pins[slot] = pin;
+  debounceTimes[slot] = debounceMs;
+  uint8_t state = 0;
+  if (pullUp) state |= STATE_PULLUP;
   if (pin == VPIN_NONE) 
-    tt->pollingRequired = false;
+    debounceTimes[slot] = 0;  // Set by setState(), no polling or debounce required
   #ifdef USE_NOTIFY
-  else if (IODevice::hasCallback(pin)) 
-    tt->pollingRequired = false;
+  else if (IODevice::hasCallback(pin)) {
+    // Sensors updated by change notification are found through the VPIN index.
+    if (!addToVpinIndex(slot)) {  // memory allocation failure
+      slotIndex.remove((int16_t)snum);
+      return false;
+    }
+  }
   #endif
   else 
-    tt->pollingRequired = true;
-
-  // Add to the start of the list
-  tt->nextSensor = firstSensor;
-  firstSensor = tt;
-
-  tt->data.snum = snum;
-  tt->data.pin = pin;
-  tt->data.pullUp = pullUp;
-  tt->active = 0;
-  tt->inputState = 0;
-  tt->latchDelay = minReadCount;
+    state |= STATE_POLL;
+  states[slot] = state;
+  count++;
+#ifdef STATIC_MEMORY_POOLS
+  if (count > highWater) highWater = count;
+#endif
 
   if (pin != VPIN_NONE) 
     IODevice::configureInput(pin, pullUp);   
     // Generally, internal pull-up resistors are not, on their own, sufficient 
     // for external infrared sensors --- each sensor must have its own 1K external pull-up resistor
 
-  return tt;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Grow the sensor table to the capacity given.  Returns false if memory allocation fails,
+// in which case the table is unchanged (though some arrays may have been enlarged).
+
+#ifdef STATIC_MEMORY_POOLS
+bool Sensor::grow(uint16_t newCapacity) {
+  (void)newCapacity;
+  if (overflows++ == 0) DIAG(F("Sensor table full (%d sensors)"), capacity);
+  return false;
+}
+
+void Sensor::printPoolUsage() {
+  MemoryPool::printUsage(F("Sensors"), count, highWater, capacity, overflows);
+}
+#else
+bool Sensor::grow(uint16_t newCapacity) {
+  int16_t *newIds = (int16_t *)realloc(ids, newCapacity * sizeof(int16_t));
+  if (!newIds) return false;
+  ids = newIds;
+  VPIN *newPins = (VPIN *)realloc(pins, newCapacity * sizeof(VPIN));
+  if (!newPins) return false;
+  pins = newPins;
+  uint8_t *newStates = (uint8_t *)realloc(states, newCapacity * sizeof(uint8_t));
+  if (!newStates) return false;
+  states = newStates;
+  uint16_t *newDebounceTimes = (uint16_t *)realloc(debounceTimes, newCapacity * sizeof(uint16_t));
+  if (!newDebounceTimes) return false;
+  debounceTimes = newDebounceTimes;
+  capacity = newCapacity;
+  return true;
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Static function to directly change the input state, for sensors such as LCN which are updated
+//  by means other than by polling an input.  Returns false if not found.
+
+bool Sensor::setState(int n, int value) {
+  uint16_t slot = findSlot(n);
+  if (slot >= count) return false;
+  // Trigger sensor change to be reported after the sensor's debounce time 
+  // (normally zero for these sensors, i.e. on the next checkAll loop).
+  setInputState(slot, value != 0);
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Object method to directly change the input state, for sensors such as LCN which are updated
-//  by means other than by polling an input.
+// Change the debounce time of an existing sensor.  Returns false if not found.
 
-void Sensor::setState(int value) {
-  // Trigger sensor change to be reported on next checkAll loop.
-  inputState = (value != 0);
-  latchDelay = 0; // Don't wait for anti-jitter logic
+bool Sensor::setDebounce(int n, uint16_t debounceMs) {
+  uint16_t slot = findSlot(n);
+  if (slot >= count) return false;
+  debounceTimes[slot] = debounceMs;
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// Find the table slot of a sensor, or count if not found.
 
-Sensor* Sensor::get(int n){
-  Sensor *tt;
-  for(tt=firstSensor;tt!=NULL && tt->data.snum!=n;tt=tt->nextSensor);
-  return tt ;
+uint16_t Sensor::findSlot(int n) {
+  return slotIndex.find((int16_t)n, count);
 }
+
 ///////////////////////////////////////////////////////////////////////////////
 
 bool Sensor::remove(int n){
-  Sensor *tt,*pp=NULL;
+  MEMORY_SCOPE(OBJECTS);
+  uint16_t slot = findSlot(n);
+  if (slot >= count) return false;
 
-  for(tt=firstSensor;tt!=NULL && tt->data.snum!=n;pp=tt,tt=tt->nextSensor);
+  // Remove from the id index, and renumber the slots which are going to move down.
+  slotIndex.remove((int16_t)n);
+  for (uint16_t i=0; i<slotIndex.count(); i++)
+    if (slotIndex.valueAt(i) > slot) slotIndex.valueAt(i)--;
 
-  if (tt==NULL)  return false;
-
-  // Unlink the sensor from the list
-  if(tt==firstSensor) 
-    firstSensor=tt->nextSensor;
-  else 
-    pp->nextSensor=tt->nextSensor;
 #ifdef USE_NOTIFY
-  if (tt==lastSensor)
-    lastSensor = pp;
-  if (tt==firstPollSensor)
-    firstPollSensor = tt->nextSensor;
+  removeFromVpinIndex(slot);
 #endif
 
-  // Check if the sensor being deleted is the next one to be read.  If so, 
-  // make the following one the next one to be read.
-  if (readingSensor==tt) readingSensor=tt->nextSensor;
+  // Remove from the pending change queue, keeping the order of the others.  Each
+  // entry is taken from the front and, unless it's the one being removed, put back
+  // at the end, renumbered if its slot is going to move down.
+  for (uint8_t remaining = pendingCount, kept = 0; remaining > 0; remaining--) {
+    uint16_t queued = pendingQueue[pendingFirst];
+    uint16_t since = pendingSince[pendingFirst];
+    if (++pendingFirst >= pendingQueueSize) pendingFirst = 0;
+    if (queued == slot) {
+      pendingCount--;
+      continue;
+    }
+    uint8_t position = (pendingFirst + remaining - 1 + kept) % pendingQueueSize;
+    pendingQueue[position] = (queued > slot) ? queued-1 : queued;
+    pendingSince[position] = since;
+    kept++;
+  }
+
+  // Close up the table.
+  count--;
+  uint16_t following = count - slot;
+  memmove(&ids[slot], &ids[slot+1], following * sizeof(int16_t));
+  memmove(&pins[slot], &pins[slot+1], following * sizeof(VPIN));
+  memmove(&states[slot], &states[slot+1], following * sizeof(uint8_t));
+  memmove(&debounceTimes[slot], &debounceTimes[slot+1], following * sizeof(uint16_t));
 
-  free(tt);
+  // If the sensor being deleted is before the next one to be read, 
+  // the next one has moved down.
+  if (readingSlot > slot) readingSlot--;
 
   return true;
 }
@@ -281,40 +469,69 @@ bool Sensor::remove(int n){
 #ifndef DISABLE_EEPROM
 void Sensor::load(){
   struct SensorData data;
-  Sensor *tt;
 
   uint16_t i=EEStore::eeStore->data.nSensors;
+  // Allocate the table and index for all the sensors at once.
+#ifndef STATIC_MEMORY_POOLS
+  if (count + i > capacity) grow(count + i);
+#endif
+  slotIndex.reserve(count + i);
   while(i--){
-    EEPROM.get(EEStore::pointer(),data);
-    tt=create(data.snum, data.pin, data.pullUp);
-    EEStore::advance(sizeof(tt->data));
+    EEStore::read(data);
+    create(data.snum, data.pin, data.pullUp);
   }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void Sensor::store(){
-  Sensor *tt;
+  struct SensorData data;
 
-  tt=firstSensor;
   EEStore::eeStore->data.nSensors=0;
 
-  while(tt!=NULL){
-    EEPROM.put(EEStore::pointer(),tt->data);
-    EEStore::advance(sizeof(tt->data));
-    tt=tt->nextSensor;
+  for (uint16_t slot=0; slot<count; slot++) {
+    data.snum = ids[slot];
+    data.pin = pins[slot];
+    data.pullUp = (states[slot] & STATE_PULLUP) ? 1 : 0;
+    EEStore::write(data);
     EEStore::eeStore->data.nSensors++;
   }
 }
 #endif
 ///////////////////////////////////////////////////////////////////////////////
 
-Sensor *Sensor::firstSensor=NULL;
-Sensor *Sensor::readingSensor=NULL;
+#ifdef STATIC_MEMORY_POOLS
+static int16_t poolIds[SENSOR_POOL_SIZE];
+static VPIN poolPins[SENSOR_POOL_SIZE];
+static uint8_t poolStates[SENSOR_POOL_SIZE];
+static uint16_t poolDebounceTimes[SENSOR_POOL_SIZE];
+int16_t *Sensor::ids=poolIds;
+VPIN *Sensor::pins=poolPins;
+uint8_t *Sensor::states=poolStates;
+uint16_t *Sensor::debounceTimes=poolDebounceTimes;
+uint16_t Sensor::capacity=SENSOR_POOL_SIZE;
+uint16_t Sensor::highWater=0;
+uint16_t Sensor::overflows=0;
+#else
+int16_t *Sensor::ids=NULL;
+VPIN *Sensor::pins=NULL;
+uint8_t *Sensor::states=NULL;
+uint16_t *Sensor::debounceTimes=NULL;
+uint16_t Sensor::capacity=0;
+#endif
+IdIndex<uint16_t> Sensor::slotIndex;
+uint16_t Sensor::count=0;
+uint16_t Sensor::readingSlot=0;
 unsigned long Sensor::lastReadCycle=0;
+uint16_t Sensor::pendingQueue[Sensor::pendingQueueSize];
+uint16_t Sensor::pendingSince[Sensor::pendingQueueSize];
+uint8_t Sensor::pendingFirst=0;
+uint8_t Sensor::pendingCount=0;
+bool Sensor::pendingOverflow=false;
 
 #ifdef USE_NOTIFY
-Sensor *Sensor::firstPollSensor = NULL;
-Sensor *Sensor::lastSensor = NULL;
 bool Sensor::inputChangeCallbackRegistered = false;
+uint16_t *Sensor::vpinIndex = NULL;
+uint16_t Sensor::vpinIndexCount = 0;
+uint16_t Sensor::vpinIndexSize = 0;
 #endif
@@ -24,73 +24,114 @@
 
 #include "Arduino.h"
 #include "IODevice.h"
+#include "IdIndex.h"
 
 // Uncomment the following #define statement to use callback notification
 //  where the driver supports it.
 //  The principle of callback notification is to avoid the Sensor class
 //  having to poll the device driver cyclically for input values, and then scan 
 //  for changes.  Instead, when the driver scans the inputs, if it detects
-//  a change it invokes a callback function in the Sensor class.  In the current
-//  implementation, the advantages are limited because (a) the Sensor class 
-//  performs debounce checks, and (b) the Sensor class does not have a 
-//  static reference to the output stream for sending <Q>/<q> messages
-//  when a change is detected.  These restrictions mean that the checkAll() 
-//  method still has to iterate through all of the Sensor objects looking 
-//  for changes.
+//  a change it invokes a callback function in the Sensor class.  The callback
+//  places the sensor on a queue of pending changes, which the checkAll() method
+//  debounces and reports, so only the sensors that require polling are scanned.
 #define USE_NOTIFY
 
 struct SensorData {
   int snum;
   VPIN pin;
   uint8_t pullUp;
-};
+};  // Format of a sensor definition in EEPROM
 
 class Sensor{
-  // The sensor list is a linked list where each sensor's 'nextSensor' field points to the next.
-  //   The pointer is null in the last on the list.
+  // The sensors are held in a table of parallel arrays (id, vpin and state bits), 
+  // in order of creation.  The arrays are contiguous, to make scans cheap, and are 
+  // grown in chunks of 'growBy' entries.  Entries move when a sensor is removed,
+  // so sensors are always referred to by id.
 
 public:
-  SensorData data;
-  struct {
-    uint8_t active:1;
-    uint8_t inputState:1;
-    uint8_t latchDelay:6;
-  };   // bit 7=active; bit 6=input state; bits 5-0=latchDelay
-
-  static Sensor *firstSensor;
-#ifdef USE_NOTIFY
-  static Sensor *firstPollSensor;
-  static Sensor *lastSensor;
-#endif
-  // readingSensor points to the next sensor to be polled, or null if the poll cycle is completed for
-  // the period.
-  static Sensor *readingSensor;
-
-  // Constructor
-  Sensor(); 
-  Sensor *nextSensor;
-
-  void setState(int state);
+  static bool setState(int id, int state);
 #ifndef DISABLE_EEPROM
   static void load();
   static void store();
 #endif
-  static Sensor *create(int id, VPIN vpin, int pullUp);
-  static Sensor* get(int id);  
+  static bool create(int id, VPIN vpin, int pullUp, uint16_t debounceMs=defaultDebounce);
+  inline static bool exists(int id) { return findSlot(id) < count; }
   static bool remove(int id);  
   static void checkAll();
   static void printAll(Print *stream);
-  static unsigned long lastReadCycle; // value of micros at start of last read cycle
-  static const unsigned int cycleInterval = 10000; // min time between consecutive reads of each sensor in microsecs.
+  static bool printDefinitions(Print *stream);
+  static bool setDebounce(int id, uint16_t debounceMs);
+#ifdef STATIC_MEMORY_POOLS
+  static void printPoolUsage();
+#endif
+  static const unsigned int cycleInterval = 10000; // min time between consecutive reads of each polled sensor in microsecs.
                                                    // should not be less than device scan cycle time.
-  static const unsigned int minReadCount = 1; // number of additional scans before acting on change
-                                        // E.g. 1 means that a change is ignored for one scan and actioned on the next.
-                                        // Max value is 63
-  bool pollingRequired = true;
+  static const uint16_t defaultDebounce = 20;  // time in millisecs that an input change must persist before 
+                                               // it is acted on, unless specified when the sensor is created.
+
+#ifdef USE_NOTIFY
+  static void inputChangeCallback(VPIN firstVpin, uint32_t changedMask, uint32_t newStates);
+#endif
+
+private:
+  // Sensor objects are never constructed.
+  Sensor() = delete;
+
+  // Bits in states[]
+  enum : uint8_t {
+    STATE_ACTIVE = 0x80,     // Reported state
+    STATE_INPUT = 0x40,      // Latest input state
+    STATE_QUEUED = 0x20,     // On pending change queue
+    STATE_POLL = 0x10,       // Input must be polled
+    STATE_PULLUP = 0x08,     // Pullup requested
+  };
+
+  static int16_t *ids;
+  static VPIN *pins;
+  static uint8_t *states;
+  static uint16_t *debounceTimes;  // Debounce time in millisecs
+  static uint16_t count;     // Number of sensors in table
+  static uint16_t capacity;  // Number of entries allocated
+  static const uint8_t growBy = 8;
+  static IdIndex<uint16_t> slotIndex;  // Table slot for each sensor id
+  static uint16_t findSlot(int id);
+  static bool grow(uint16_t newCapacity);
+#ifdef STATIC_MEMORY_POOLS
+  // The table has a fixed size of SENSOR_POOL_SIZE entries.
+  static uint16_t highWater;  // Maximum number of sensors in table
+  static uint16_t overflows;  // Number of sensors not created because the table was full
+#endif
+
+  static void setInputState(uint16_t slot, bool state);
+  static void queuePending(uint16_t slot);
+  static void processPending();
+  static void recoverPending();
+  // Queue of sensors (slots) with input changes not yet validated and reported, along
+  // with the time (millis, low 16 bits) of the latest input change.  A sensor whose 
+  // input is stable is not on the queue, and costs nothing here.  If the queue 
+  // overflows, the sensor table is scanned to recover.
+  static const uint8_t pendingQueueSize = 16;
+  static uint16_t pendingQueue[pendingQueueSize];
+  static uint16_t pendingSince[pendingQueueSize];
+  static uint8_t pendingFirst;
+  static uint8_t pendingCount;
+  static bool pendingOverflow;
+
+  // readingSlot is the next sensor to be polled, or count if the poll cycle is completed for
+  // the period.
+  static uint16_t readingSlot;
+  static unsigned long lastReadCycle; // value of micros at start of last read cycle
 
 #ifdef USE_NOTIFY
-  static void inputChangeCallback(VPIN vpin, int state);
   static bool inputChangeCallbackRegistered;
+  // Index of the sensors that are updated by change notification (slots), sorted by VPIN,
+  // so that the sensors affected by a notification can be found by binary search.
+  static uint16_t *vpinIndex;
+  static uint16_t vpinIndexCount;  // Number of entries in use
+  static uint16_t vpinIndexSize;   // Number of entries allocated
+  static uint16_t vpinIndexLowerBound(VPIN vpin);
+  static bool addToVpinIndex(uint16_t slot);
+  static void removeFromVpinIndex(uint16_t slot);
 #endif
   
 }; // Sensor
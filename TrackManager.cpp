@@ -26,13 +26,19 @@
 #include "DCCTimer.h"
 #include "DIAG.h"
 #include"CommandDistributor.h"
+#include "CurrentTelemetry.h"
+#ifndef DISABLE_EEPROM
+#include "EEStore.h"
+#endif
 // Virtualised Motor shield multi-track hardware Interface
 #define FOR_EACH_TRACK(t) for (byte t=0;t<=lastTrack;t++)
     
-#define APPLY_BY_MODE(findmode,function) \
-        FOR_EACH_TRACK(t) \
-	    if (track[t]->getMode()==findmode)	\
-                track[t]->function;
+// Loop over the tracks in one mode (see updateModeTracks), i indexes modeTracks[] and modeDrivers[]
+#define FOR_EACH_MODE_TRACK(modeIndex,i) for (byte i=modeStart[modeIndex];i<modeStart[modeIndex+1];i++)
+
+#define APPLY_BY_MODE(modeIndex,function) \
+        FOR_EACH_MODE_TRACK(modeIndex,i) \
+                modeDrivers[i]->function;
 #ifndef DISABLE_PROG
 const int16_t HASH_KEYWORD_PROG = -29718;
 #endif
@@ -46,6 +52,13 @@ const int16_t HASH_KEYWORD_A = 65; // parser makes single chars the ascii.
 
 MotorDriver * TrackManager::track[MAX_TRACKS];
 int16_t TrackManager::trackDCAddr[MAX_TRACKS];
+byte TrackManager::modeTracks[MAX_TRACKS];
+MotorDriver * TrackManager::modeDrivers[MAX_TRACKS];
+byte TrackManager::modeStart[INDEX_COUNT+1];
+TrackManager::SignalPort TrackManager::signalPorts[MAX_SIGNAL_PORTS];
+byte TrackManager::signalPortStart[GROUP_COUNT+1];
+MotorDriver * TrackManager::signalDrivers[MAX_TRACKS];
+byte TrackManager::signalDriverStart[GROUP_COUNT+1];
 
 POWERMODE TrackManager::mainPowerGuess=POWERMODE::OFF;
 byte TrackManager::lastTrack=0;
@@ -147,47 +160,121 @@ void TrackManager::addTrack(byte t, MotorDriver* driver) {
      } 
 }
 
-// setDCCSignal(), called from interrupt context
-// does assume ports are shadowed if they can be
-void TrackManager::setDCCSignal( bool on) {
+// setSignalGroup(), called from interrupt context
+// Sets the signal pins of all the tracks in the group with one
+// read-modify-write per port, then the remaining tracks one by one.
+// The latter assume ports are shadowed if they can be.
+void TrackManager::setSignalGroup(SIGNAL_GROUP group, bool on) {
+  for (byte i=signalPortStart[group];i<signalPortStart[group+1];i++) {
+    SignalPort * sp=&signalPorts[i];
+    if (on) *sp->port = (*sp->port & ~sp->clearOnHigh) | sp->setOnHigh;
+    else    *sp->port = (*sp->port & ~sp->setOnHigh) | sp->clearOnHigh;
+  }
+  if (signalDriverStart[group]==signalDriverStart[group+1]) return;
   HAVE_PORTA(shadowPORTA=PORTA);
   HAVE_PORTB(shadowPORTB=PORTB);
   HAVE_PORTC(shadowPORTC=PORTC);
-  APPLY_BY_MODE(TRACK_MODE_MAIN,setSignal(on));
+  for (byte i=signalDriverStart[group];i<signalDriverStart[group+1];i++)
+    signalDrivers[i]->setSignal(on);
   HAVE_PORTA(PORTA=shadowPORTA);
   HAVE_PORTB(PORTB=shadowPORTB);
   HAVE_PORTC(PORTC=shadowPORTC);
 }
 
+// setDCCSignal(), called from interrupt context
+void TrackManager::setDCCSignal( bool on) {
+  setSignalGroup(GROUP_MAIN,on);
+}
+
 void TrackManager::setCutout( bool on) {
     (void) on;
     // TODO Cutout needs fake ports as well
-    // TODO      APPLY_BY_MODE(TRACK_MODE_MAIN,setCutout(on));
+    // TODO      APPLY_BY_MODE(INDEX_MAIN,setCutout(on));
 }
 
 // setPROGSignal(), called from interrupt context
-// does assume ports are shadowed if they can be
 void TrackManager::setPROGSignal( bool on) {
-  HAVE_PORTA(shadowPORTA=PORTA);
-  HAVE_PORTB(shadowPORTB=PORTB);
-  HAVE_PORTC(shadowPORTC=PORTC);
-  APPLY_BY_MODE(TRACK_MODE_PROG,setSignal(on));
-  HAVE_PORTA(PORTA=shadowPORTA);
-  HAVE_PORTB(PORTB=shadowPORTB);
-  HAVE_PORTC(PORTC=shadowPORTC);
+  setSignalGroup(GROUP_PROG,on);
 }
 
 // setDCSignal(), called from normal context
 // MotorDriver::setDCSignal handles shadowed IO port changes.
 // with interrupts turned off around the critical section
 void TrackManager::setDCSignal(int16_t cab, byte speedbyte) {
-  FOR_EACH_TRACK(t) {
-    if (trackDCAddr[t]!=cab && cab != 0) continue;
-    if (track[t]->getMode()==TRACK_MODE_DC) track[t]->setDCSignal(speedbyte);
-    else if (track[t]->getMode()==TRACK_MODE_DCX) track[t]->setDCSignal(speedbyte ^ 128);
+  FOR_EACH_MODE_TRACK(INDEX_DC,i) {
+    if (trackDCAddr[modeTracks[i]]!=cab && cab != 0) continue;
+    modeDrivers[i]->setDCSignal(speedbyte);
+  }
+  FOR_EACH_MODE_TRACK(INDEX_DCX,i) {
+    if (trackDCAddr[modeTracks[i]]!=cab && cab != 0) continue;
+    modeDrivers[i]->setDCSignal(speedbyte ^ 128);
   }
 }    
 
+// Rebuild the lists of tracks by mode.  Interrupts are held off while
+// the lists are changed, as setDCCSignal() and setPROGSignal() use them.
+void TrackManager::updateModeTracks() {
+  static const TRACK_MODE modes[INDEX_COUNT]={TRACK_MODE_MAIN, TRACK_MODE_PROG,
+                                              TRACK_MODE_DC, TRACK_MODE_DCX, TRACK_MODE_EXT};
+  noInterrupts();
+  byte n=0;
+  for (byte index=0;index<INDEX_COUNT;index++) {
+    modeStart[index]=n;
+    FOR_EACH_TRACK(t)
+      if (track[t] && track[t]->getMode()==modes[index]) {
+        modeTracks[n]=t;
+        modeDrivers[n]=track[t];
+        n++;
+      }
+  }
+  modeStart[INDEX_COUNT]=n;
+  updateSignalPorts();
+  interrupts();
+}
+
+// Group the signal pins of the MAIN and PROG tracks by output register.
+// Called by updateModeTracks() with interrupts off.
+void TrackManager::updateSignalPorts() {
+  static const MODE_INDEX groupModes[GROUP_COUNT]={INDEX_MAIN, INDEX_PROG};
+  byte nPorts=0;
+  byte nDrivers=0;
+  for (byte group=0;group<GROUP_COUNT;group++) {
+    signalPortStart[group]=nPorts;
+    signalDriverStart[group]=nDrivers;
+    FOR_EACH_MODE_TRACK(groupModes[group],i) {
+      MotorDriver * driver=modeDrivers[i];
+      // A track needs at most two more ports
+      if (driver->trackPWM || nPorts+2 > MAX_SIGNAL_PORTS) {
+        signalDrivers[nDrivers++]=driver;
+        continue;
+      }
+      addSignalPin(signalPortStart[group],nPorts,driver->getFastSignalPin(0),true);
+      addSignalPin(signalPortStart[group],nPorts,driver->getFastSignalPin(1),false);
+    }
+  }
+  signalPortStart[GROUP_COUNT]=nPorts;
+  signalDriverStart[GROUP_COUNT]=nDrivers;
+}
+
+// Add a signal pin to the group of ports starting at signalPorts[first].
+// The pin is set to the signal, or to its inverse if followsSignal is false.
+void TrackManager::addSignalPin(byte first, byte &count, const FASTPIN *pin, bool followsSignal) {
+  if (pin==NULL) return;
+  // Shadowed pins are written to the real port here
+  volatile portreg_t * port= pin->shadowinout ? pin->shadowinout : pin->inout;
+  SignalPort * sp=NULL;
+  for (byte i=first;i<count;i++)
+    if (signalPorts[i].port==port) sp=&signalPorts[i];
+  if (sp==NULL) {
+    sp=&signalPorts[count++];
+    sp->port=port;
+    sp->setOnHigh=0;
+    sp->clearOnHigh=0;
+  }
+  if (followsSignal) sp->setOnHigh |= pin->maskHIGH;
+  else sp->clearOnHigh |= pin->maskHIGH;
+}
+
 bool TrackManager::setTrackMode(byte trackToSet, TRACK_MODE mode, int16_t dcAddr) {
     if (trackToSet>lastTrack || track[trackToSet]==NULL) return false;
 
@@ -235,6 +322,7 @@ bool TrackManager::setTrackMode(byte trackToSet, TRACK_MODE mode, int16_t dcAddr
     }
     track[trackToSet]->setMode(mode);
     trackDCAddr[trackToSet]=dcAddr;
+    updateModeTracks();
     streamTrackState(NULL,trackToSet);
 
     // When a track is switched, we must clear any side effects of its previous 
@@ -283,6 +371,7 @@ bool TrackManager::setTrackMode(byte trackToSet, TRACK_MODE mode, int16_t dcAddr
       }
       DCCTimer::clearPWM(); // has to be AFTER trackPWM changes because if trackPWM==true this is undone for  that track
     }
+    updateModeTracks(); // trackPWM decides how the signal pins are set
 #else
     // For ESP32 we just reinitialize the DCC Waveform
     DCCWaveform::begin();
@@ -386,6 +475,9 @@ void TrackManager::loop() {
     DCCWaveform::loop();
 #ifndef DISABLE_PROG
     DCCACK::loop();
+#endif
+#if defined(HAS_ENOUGH_MEMORY)
+    CurrentTelemetry::loop();
 #endif
     bool dontLimitProg=DCCACK::isActive() || progTrackSyncMain || progTrackBoosted;
     nextCycleTrack++;
@@ -397,63 +489,61 @@ void TrackManager::loop() {
 }
 
 MotorDriver * TrackManager::getProgDriver() {
-    FOR_EACH_TRACK(t)
-      if (track[t]->getMode()==TRACK_MODE_PROG) return track[t];
+    if (modeStart[INDEX_PROG]<modeStart[INDEX_PROG+1])
+      return modeDrivers[modeStart[INDEX_PROG]];
     return NULL;
 } 
 
 #ifdef ARDUINO_ARCH_ESP32
-std::vector<MotorDriver *>TrackManager::getMainDrivers() {
-  std::vector<MotorDriver *>  v;
-  FOR_EACH_TRACK(t)
-    if (track[t]->getMode()==TRACK_MODE_MAIN) v.push_back(track[t]);
-  return v;
+TrackDrivers TrackManager::getMainDrivers() {
+  return {&modeDrivers[modeStart[INDEX_MAIN]], &modeDrivers[modeStart[INDEX_MAIN+1]]};
 }
 #endif
 
 void TrackManager::setPower2(bool setProg,POWERMODE mode) {
     if (!setProg) mainPowerGuess=mode; 
-    FOR_EACH_TRACK(t) {
-        MotorDriver * driver=track[t]; 
-        if (!driver) continue; 
-        switch (track[t]->getMode()) {
-            case TRACK_MODE_MAIN:
-                if (setProg) break; 
-                // toggle brake before turning power on - resets overcurrent error
-                // on the Pololu board if brake is wired to ^D2.
-		// XXX see if we can make this conditional
-                driver->setBrake(true);
-                driver->setBrake(false); // DCC runs with brake off
-                driver->setPower(mode);  
-                break; 
-            case TRACK_MODE_DC:
-            case TRACK_MODE_DCX:
-                if (setProg) break; 
-                driver->setBrake(true); // DC starts with brake on
-                applyDCSpeed(t);        // speed match DCC throttles
-                driver->setPower(mode);
-                break;  
-            case TRACK_MODE_PROG:
-                if (!setProg) break; 
-                driver->setBrake(true);
-                driver->setBrake(false);
-                driver->setPower(mode);
-                break;  
-            case TRACK_MODE_EXT:
-	        driver->setBrake(true);
-	        driver->setBrake(false);
-		driver->setPower(mode);
-	        break;
-            case TRACK_MODE_NONE:
-                break;
-        }
+    if (setProg) {
+      FOR_EACH_MODE_TRACK(INDEX_PROG,i) {
+        MotorDriver * driver=modeDrivers[i];
+        driver->setBrake(true);
+        driver->setBrake(false);
+        driver->setPower(mode);
+      }
+    } else {
+      FOR_EACH_MODE_TRACK(INDEX_MAIN,i) {
+        MotorDriver * driver=modeDrivers[i];
+        // toggle brake before turning power on - resets overcurrent error
+        // on the Pololu board if brake is wired to ^D2.
+	// XXX see if we can make this conditional
+        driver->setBrake(true);
+        driver->setBrake(false); // DCC runs with brake off
+        driver->setPower(mode);
+      }
+      // DC and DCX are consecutive in the lists
+      for (byte i=modeStart[INDEX_DC];i<modeStart[INDEX_DCX+1];i++) {
+        MotorDriver * driver=modeDrivers[i];
+        driver->setBrake(true);        // DC starts with brake on
+        applyDCSpeed(modeTracks[i]);   // speed match DCC throttles
+        driver->setPower(mode);
+      }
+    }
+    // EXT tracks follow both main and prog power
+    FOR_EACH_MODE_TRACK(INDEX_EXT,i) {
+      MotorDriver * driver=modeDrivers[i];
+      driver->setBrake(true);
+      driver->setBrake(false);
+      driver->setPower(mode);
     }
+#ifndef DISABLE_EEPROM
+    // Power may be about to be removed from the command station too, so
+    // write any outstanding state changes now, in the background.
+    if (!setProg && mode==POWERMODE::OFF) EEStore::flush();
+#endif
 }
   
 POWERMODE TrackManager::getProgPower() {
-    FOR_EACH_TRACK(t)
-      if (track[t]->getMode()==TRACK_MODE_PROG) 
-	return track[t]->getPower();
+    MotorDriver * driver=getProgDriver();
+    if (driver) return driver->getPower();
     return POWERMODE::OFF;   
   }
 
@@ -485,6 +575,21 @@ void TrackManager::reportGauges(Print* stream) {
     StringFormatter::send(stream,F(">\n"));    
 }
 
+// <D TRIP track [curveMs hardPercent filterShift]>
+// Set the overload trip curve of a track (see MotorDriver::setTripCurve),
+// and report it.
+bool TrackManager::setTripCurve(byte t, int16_t params, int16_t p[]) {
+  if (t >= MAX_TRACKS || track[t] == NULL) return false;
+  if (params >= 3) {
+    if (p[0] < 0 || p[1] < 0 || p[2] < 0 || p[2] > 8
+        || !track[t]->setTripCurve(p[0], p[1], p[2]))
+      return false;
+  } else if (params != 0)
+    return false;
+  track[t]->reportTripCurve(t);
+  return true;
+}
+
 void TrackManager::setJoinRelayPin(byte joinRelayPin) {
   joinRelay=joinRelayPin;
   if (joinRelay!=UNUSED_PIN) {
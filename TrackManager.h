@@ -18,11 +18,9 @@
  *  You should have received a copy of the GNU General Public License
  *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
  */
-#ifdef ARDUINO_ARCH_ESP32
-#include <vector>
-#endif
 #ifndef TrackManager_h
 #define TrackManager_h
+#include "defines.h"
 #include "FSH.h"
 #include "MotorDriver.h"
 // Virtualised Motor shield multi-track hardware Interface
@@ -37,6 +35,14 @@ const byte TRACK_NUMBER_5=5, TRACK_NUMBER_F=5;
 const byte TRACK_NUMBER_6=6, TRACK_NUMBER_G=6;    
 const byte TRACK_NUMBER_7=7, TRACK_NUMBER_H=7;    
 
+// Drivers of the tracks in one mode, usable in range-based for loops.
+struct TrackDrivers {
+  MotorDriver * const * first;
+  MotorDriver * const * last;
+  MotorDriver * const * begin() const { return first; }
+  MotorDriver * const * end() const { return last; }
+};
+
 class TrackManager {
   public:
     static void Setup(const FSH * shieldName,
@@ -56,7 +62,7 @@ class TrackManager {
     static void setDCSignal(int16_t cab, byte speedbyte);
     static MotorDriver * getProgDriver();
 #ifdef ARDUINO_ARCH_ESP32
-  static std::vector<MotorDriver *>getMainDrivers();
+    static TrackDrivers getMainDrivers();
 #endif
     static void setPower2(bool progTrack,POWERMODE mode);
     static void setPower(POWERMODE mode) {setMainPower(mode); setProgPower(mode);}
@@ -72,6 +78,7 @@ class TrackManager {
     static void setJoin(bool join);
     static bool isJoined() { return progTrackSyncMain;}
     static void setJoinRelayPin(byte joinRelayPin);
+    static bool setTripCurve(byte t, int16_t params, int16_t p[]);
     static void sampleCurrent();
     static void reportGauges(Print* stream);
     static void reportCurrent(Print* stream);
@@ -88,6 +95,7 @@ class TrackManager {
   private:
 #endif
     static MotorDriver* track[MAX_TRACKS];
+    friend class CurrentTelemetry;
 
   private:
     static void addTrack(byte t, MotorDriver* driver);
@@ -97,6 +105,41 @@ class TrackManager {
     static void applyDCSpeed(byte t);
 
     static int16_t trackDCAddr[MAX_TRACKS];  // dc address if TRACK_MODE_DC or TRACK_MODE_DCX
+
+    // The tracks partitioned by mode, rebuilt by updateModeTracks() whenever
+    // a mode changes, so that the interrupt handler and the power and DC speed
+    // functions don't have to look through all the tracks.  The tracks in the
+    // mode with index i are modeTracks[modeStart[i]] to modeTracks[modeStart[i+1]-1],
+    // with their drivers in modeDrivers[].
+    enum MODE_INDEX : byte {INDEX_MAIN, INDEX_PROG, INDEX_DC, INDEX_DCX, INDEX_EXT, INDEX_COUNT};
+    static byte modeTracks[MAX_TRACKS];
+    static MotorDriver* modeDrivers[MAX_TRACKS];
+    static byte modeStart[INDEX_COUNT+1];
+    static void updateModeTracks();
+
+    // The signal pins of the MAIN and PROG tracks grouped by output register,
+    // so that the interrupt handler writes each register once for all the
+    // tracks in a group (see updateSignalPorts).  Tracks that generate the
+    // signal with the PWM timer, or whose pins don't fit, are listed in
+    // signalDrivers[] to be set one at a time.
+    enum SIGNAL_GROUP : byte {GROUP_MAIN, GROUP_PROG, GROUP_COUNT};
+    struct SignalPort {
+      volatile portreg_t *port;
+      portreg_t setOnHigh;    // pins that are high when the signal is high
+      portreg_t clearOnHigh;  // pins that are low when the signal is high
+    };
+#if defined(HAS_ENOUGH_MEMORY)
+    static const byte MAX_SIGNAL_PORTS=2*MAX_TRACKS;
+#else
+    static const byte MAX_SIGNAL_PORTS=4;
+#endif
+    static SignalPort signalPorts[MAX_SIGNAL_PORTS];
+    static byte signalPortStart[GROUP_COUNT+1];
+    static MotorDriver* signalDrivers[MAX_TRACKS];
+    static byte signalDriverStart[GROUP_COUNT+1];
+    static void updateSignalPorts();
+    static void addSignalPin(byte first, byte &count, const FASTPIN *pin, bool followsSignal);
+    static void setSignalGroup(SIGNAL_GROUP group, bool on);
 #ifdef ARDUINO_ARCH_ESP32
     static byte tempProgTrack; // holds the prog track number during join
 #endif
@@ -34,6 +34,7 @@
 #include "Turnouts.h"
 #include "DCC.h"
 #include "LCN.h"
+#include "MemoryStats.h"
 #ifdef EESTOREDEBUG
 #include "DIAG.h"
 #endif
@@ -43,6 +44,17 @@
    */ 
 
   /* static */ Turnout *Turnout::_firstTurnout = 0;
+  /* static */ Turnout *Turnout::_lastTurnout = 0;
+  /* static */ IdIndex<Turnout *> Turnout::_turnoutIndex;
+
+#ifdef STATIC_MEMORY_POOLS
+  static constexpr size_t largest(size_t a, size_t b) { return a > b ? a : b; }
+  static const size_t turnoutBlockSize = POOL_BLOCK_SIZE(
+    largest(largest(sizeof(ServoTurnout), sizeof(DCCTurnout)), 
+            largest(sizeof(VpinTurnout), sizeof(LCNTurnout))));
+  POOL_STORAGE(turnoutPoolStorage, turnoutBlockSize * TURNOUT_POOL_SIZE);
+  /* static */ MemoryPool Turnout::pool(turnoutPoolStorage, turnoutBlockSize, TURNOUT_POOL_SIZE);
+#endif
 
   /* 
    * Public static data
@@ -54,30 +66,34 @@
    */
 
   /* static */ Turnout *Turnout::get(uint16_t id) {
-    // Find turnout object from list.
-    for (Turnout *tt = _firstTurnout; tt != NULL; tt = tt->_nextTurnout)
-      if (tt->_turnoutData.id == id) return tt;
-    return NULL;
+    // Find turnout object from index.
+    return _turnoutIndex.find(id, NULL);
   }
 
-  // Add new turnout to end of chain
-  /* static */ void Turnout::add(Turnout *tt) {
+  // Add new turnout to the index, and to end of chain, so that the chain stays in 
+  // the order of creation for listing.  If the turnout couldn't be allocated, or 
+  // there is no memory to index it, the turnout is deleted and false returned.
+  /* static */ bool Turnout::add(Turnout *tt) {
+    if (!tt) return false;
+    if (!_turnoutIndex.insert(tt->_turnoutData.id, tt)) {
+      DIAG(F("Turnout %d not created, out of memory"), tt->_turnoutData.id);
+      delete tt;
+      return false;
+    }
     if (!_firstTurnout) 
       _firstTurnout = tt;
-    else {
-      // Find last object on chain
-      Turnout *ptr = _firstTurnout;
-      for ( ; ptr->_nextTurnout!=0; ptr=ptr->_nextTurnout) {}
-      // Line new object to last object.
-      ptr->_nextTurnout = tt;
-    }
+    else
+      _lastTurnout->_nextTurnout = tt;
+    _lastTurnout = tt;
     turnoutlistHash++;
+    return true;
   }
   
   
 
   // Remove nominated turnout from turnout linked list and delete the object.
   /* static */ bool Turnout::remove(uint16_t id) {
+    MEMORY_SCOPE(OBJECTS);
     Turnout *tt,*pp=NULL;
 
     for(tt=_firstTurnout; tt!=NULL && tt->_turnoutData.id!=id; pp=tt, tt=tt->_nextTurnout) {}
@@ -87,6 +103,9 @@
       _firstTurnout = tt->_nextTurnout;
     else
       pp->_nextTurnout = tt->_nextTurnout;
+    if (tt == _lastTurnout)
+      _lastTurnout = pp;
+    _turnoutIndex.remove(id);
 
     delete (ServoTurnout *)tt;
 
@@ -139,10 +158,10 @@
     if (ok) {
       tt->setClosedStateOnly(id, closeFlag);
 #ifndef DISABLE_EEPROM
-      // Write byte containing new closed/thrown state to EEPROM if required.  Note that eepromAddress
-      // is always zero for LCN turnouts.
+      // Save new closed/thrown state to EEPROM (in the background) if required.  
+      // Note that eepromAddress is always zero for LCN turnouts.
       if (EEStore::eeStore->data.nTurnouts > 0 && tt->_eepromAddress > 0) 
-        EEPROM.put(tt->_eepromAddress, tt->_turnoutData.flags);
+        EEStore::saveState(EEStore::STATE_TURNOUT, id, closeFlag);
 #endif
     }
     return ok;
@@ -151,6 +170,7 @@
 #ifndef DISABLE_EEPROM
   // Load all turnout objects
   /* static */ void Turnout::load() {
+    _turnoutIndex.reserve(_turnoutIndex.count() + EEStore::eeStore->data.nTurnouts);
     for (uint16_t i=0; i<EEStore::eeStore->data.nTurnouts; i++) {
       Turnout::loadTurnout();
     }
@@ -160,19 +180,42 @@
   /* static */ void Turnout::store() {
     EEStore::eeStore->data.nTurnouts=0;
     for (Turnout *tt = _firstTurnout; tt != 0; tt = tt->_nextTurnout) {
+      int eepromAddress = EEStore::pointer();
       tt->save();
+      if (EEStore::pointer() != eepromAddress)  // Not for LCN turnouts
+        tt->_eepromAddress = eepromAddress + offsetof(struct TurnoutData, flags);
       EEStore::eeStore->data.nTurnouts++;
     }
   }
 
+  // For the EEStore journal snapshot, find the next saved turnout from position 
+  // 'index' in the list whose state differs from the state in its EEPROM definition.
+  /* static */ bool Turnout::nextChangedState(uint16_t &index, uint16_t &id, uint8_t &state) {
+    uint16_t n = 0;
+    for (Turnout *tt = _firstTurnout; tt != 0; tt = tt->_nextTurnout, n++) {
+      if (n < index || tt->_eepromAddress == 0) continue;
+      struct TurnoutData turnoutData;
+      turnoutData.flags = EEPROM.read(tt->_eepromAddress);
+      if (turnoutData.closed != tt->_turnoutData.closed) {
+        index = n + 1;
+        id = tt->_turnoutData.id;
+        state = tt->_turnoutData.closed;
+        return true;
+      }
+    }
+    index = n;
+    return false;
+  }
+
   // Load one turnout from EEPROM
   /* static */ Turnout *Turnout::loadTurnout () {
     Turnout *tt = 0;
     // Read turnout type from EEPROM
     struct TurnoutData turnoutData;
     int eepromAddress = EEStore::pointer() + offsetof(struct TurnoutData, flags); // Address of byte containing the closed flag.
-    EEPROM.get(EEStore::pointer(), turnoutData);
-    EEStore::advance(sizeof(turnoutData));
+    EEStore::read(turnoutData);
+    // Latest state may be in the EEStore journal.
+    turnoutData.closed = EEStore::restoredState(EEStore::STATE_TURNOUT, turnoutData.id, turnoutData.closed);
 
     switch (turnoutData.turnoutType) {
       case TURNOUT_SERVO:
@@ -221,6 +264,7 @@
 
   // Create function
   /* static */ Turnout *ServoTurnout::create(uint16_t id, VPIN vpin, uint16_t thrownPosition, uint16_t closedPosition, uint8_t profile, bool closed) {
+    MEMORY_SCOPE(OBJECTS);
 #ifndef IO_NO_HAL
     Turnout *tt = get(id);
     if (tt) { 
@@ -250,6 +294,7 @@
       }
     }
     tt = (Turnout *)new ServoTurnout(id, vpin, thrownPosition, closedPosition, profile, closed);
+    if (!add(tt)) return NULL;
     DIAG(F("Turnout 0x%x size %d size %d"), tt, sizeof(Turnout),sizeof(struct TurnoutData));
     IODevice::writeAnalogue(vpin, closed ? closedPosition : thrownPosition, PCA9685::Instant);
     return tt;
@@ -265,8 +310,7 @@
 #ifndef DISABLE_EEPROM
     ServoTurnoutData servoTurnoutData;
     // Read class-specific data from EEPROM
-    EEPROM.get(EEStore::pointer(), servoTurnoutData);
-    EEStore::advance(sizeof(servoTurnoutData));
+    EEStore::read(servoTurnoutData);
     
     // Create new object
     Turnout *tt = ServoTurnout::create(turnoutData->id, servoTurnoutData.vpin, servoTurnoutData.thrownPosition,
@@ -301,10 +345,8 @@
     // Write turnout definition and current position to EEPROM
     // First write common servo data, then
     // write the servo-specific data
-    EEPROM.put(EEStore::pointer(), _turnoutData);
-    EEStore::advance(sizeof(_turnoutData));
-    EEPROM.put(EEStore::pointer(), _servoTurnoutData);
-    EEStore::advance(sizeof(_servoTurnoutData));
+    EEStore::write(_turnoutData);
+    EEStore::write(_servoTurnoutData);
 #endif
   }
 
@@ -337,6 +379,7 @@
 
   // Create function
   /* static */ Turnout *DCCTurnout::create(uint16_t id, uint16_t add, uint8_t subAdd) {
+    MEMORY_SCOPE(OBJECTS);
     Turnout *tt = get(id);
     if (tt) { 
       // Object already exists, check if it is usable
@@ -353,6 +396,7 @@
       }
     }
     tt = (Turnout *)new DCCTurnout(id, add, subAdd);
+    if (!Turnout::add(tt)) return NULL;
     return tt;
   }
 
@@ -361,11 +405,11 @@
 #ifndef DISABLE_EEPROM
     DCCTurnoutData dccTurnoutData;
     // Read class-specific data from EEPROM
-    EEPROM.get(EEStore::pointer(), dccTurnoutData);
-    EEStore::advance(sizeof(dccTurnoutData));
+    EEStore::read(dccTurnoutData);
     
     // Create new object
     DCCTurnout *tt = new DCCTurnout(turnoutData->id, dccTurnoutData.address, dccTurnoutData.subAddress);
+    if (!add(tt)) return NULL;
 
     return tt;
 #else
@@ -395,10 +439,8 @@
     // Write turnout definition and current position to EEPROM
     // First write common servo data, then
     // write the servo-specific data
-    EEPROM.put(EEStore::pointer(), _turnoutData);
-    EEStore::advance(sizeof(_turnoutData));
-    EEPROM.put(EEStore::pointer(), _dccTurnoutData);
-    EEStore::advance(sizeof(_dccTurnoutData));
+    EEStore::write(_turnoutData);
+    EEStore::write(_dccTurnoutData);
 #endif
   }
 
@@ -418,6 +460,7 @@
 
   // Create function
   /* static */ Turnout *VpinTurnout::create(uint16_t id, VPIN vpin, bool closed) {
+    MEMORY_SCOPE(OBJECTS);
     Turnout *tt = get(id);
     if (tt) { 
       // Object already exists, check if it is usable
@@ -433,6 +476,7 @@
       }
     }
     tt = (Turnout *)new VpinTurnout(id, vpin, closed);
+    if (!add(tt)) return NULL;
     return tt;
   }
 
@@ -441,11 +485,11 @@
 #ifndef DISABLE_EEPROM
     VpinTurnoutData vpinTurnoutData;
     // Read class-specific data from EEPROM
-    EEPROM.get(EEStore::pointer(), vpinTurnoutData);
-    EEStore::advance(sizeof(vpinTurnoutData));
+    EEStore::read(vpinTurnoutData);
     
     // Create new object
     VpinTurnout *tt = new VpinTurnout(turnoutData->id, vpinTurnoutData.vpin, turnoutData->closed);
+    if (!add(tt)) return NULL;
 
     return tt;
 #else
@@ -470,10 +514,8 @@
     // Write turnout definition and current position to EEPROM
     // First write common servo data, then
     // write the servo-specific data
-    EEPROM.put(EEStore::pointer(), _turnoutData);
-    EEStore::advance(sizeof(_turnoutData));
-    EEPROM.put(EEStore::pointer(), _vpinTurnoutData);
-    EEStore::advance(sizeof(_vpinTurnoutData));
+    EEStore::write(_turnoutData);
+    EEStore::write(_vpinTurnoutData);
 #endif
   }
 
@@ -494,6 +536,7 @@
 
   // Create function
   /* static */ Turnout *LCNTurnout::create(uint16_t id, bool closed) {
+    MEMORY_SCOPE(OBJECTS);
     Turnout *tt = get(id);
     if (tt) { 
       // Object already exists, check if it is usable
@@ -506,6 +549,7 @@
       }
     }
     tt = (Turnout *)new LCNTurnout(id, closed);
+    if (!add(tt)) return NULL;
     return tt;
   }
 
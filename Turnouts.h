@@ -30,6 +30,8 @@
 #include "Arduino.h"
 #include "IODevice.h"
 #include "StringFormatter.h"
+#include "IdIndex.h"
+#include "MemoryPool.h"
 
 // Turnout type definitions
 enum {
@@ -70,9 +72,9 @@ protected:
   } _turnoutData;  // 3 bytes
 
 #ifndef DISABLE_EEPROM
-  // Address in eeprom of first byte of the _turnoutData struct (containing the closed flag).
-  // Set to zero if the object has not been saved in EEPROM, e.g. for newly created Turnouts, and 
-  // for all LCN turnouts.
+  // Address in eeprom of first byte of the _turnoutData struct (containing the closed flag
+  // as at the last save).  Set to zero if the object has not been saved in EEPROM, e.g. for 
+  // newly created Turnouts, and for all LCN turnouts.
   uint16_t _eepromAddress = 0;
 #endif
 
@@ -87,7 +89,6 @@ protected:
     _turnoutData.turnoutType = turnoutType;
     _turnoutData.closed = closed;
     _turnoutData.hidden=false;
-    add(this);
   }
 
   /* 
@@ -95,6 +96,8 @@ protected:
    */ 
 
   static Turnout *_firstTurnout;
+  static Turnout *_lastTurnout;
+  static IdIndex<Turnout *> _turnoutIndex;  // For lookup by id
   static int _turnoutlistHash;
 
   /* 
@@ -109,7 +112,7 @@ protected:
    */
 
 
-  static void add(Turnout *tt);
+  static bool add(Turnout *tt);
   
 public:
   static Turnout *get(uint16_t id);
@@ -138,6 +141,14 @@ public:
   }
   virtual ~Turnout() {}   // Destructor
 
+#ifdef STATIC_MEMORY_POOLS
+  // Turnouts of all types are allocated from one pool, with blocks big enough
+  // for the largest type.
+  static MemoryPool pool;
+  static void *operator new(size_t size) { (void)size; return pool.allocate(); }
+  static void operator delete(void *tt) { pool.release(tt); }
+#endif
+
   /*
    * Public static functions
    */
@@ -172,6 +183,9 @@ public:
   static Turnout *loadTurnout();
   // Save all turnout definitions
   static void store();
+  // Find the next turnout, from position 'index' in the list, whose state
+  // differs from its definition.  Returns false if there are no more.
+  static bool nextChangedState(uint16_t &index, uint16_t &id, uint8_t &state);
 #endif
   static bool printAll(Print *stream) {
     bool gotOne=false;
@@ -57,6 +57,7 @@
 #include "CommandDistributor.h"
 #include "TrackManager.h"
 #include "DCCTimer.h"
+#include "MemoryStats.h"
 
 #define LOOPLOCOS(THROTTLECHAR, CAB)  for (int loco=0;loco<MAX_MY_LOCO;loco++) \
       if ((myLocos[loco].throttle==THROTTLECHAR || '*'==THROTTLECHAR) && (CAB<0 || myLocos[loco].cab==CAB))
@@ -66,6 +67,7 @@ WiThrottle * WiThrottle::firstThrottle=NULL;
 WiThrottle* WiThrottle::getThrottle( int wifiClient) {
   for (WiThrottle* wt=firstThrottle; wt!=NULL ; wt=wt->nextThrottle)  
      if (wt->clientid==wifiClient) return wt; 
+  MEMORY_SCOPE(NETWORK);
   return new WiThrottle( wifiClient);
 }
 
@@ -73,6 +75,7 @@ void WiThrottle::forget( byte clientId) {
   for (WiThrottle* wt=firstThrottle; wt!=NULL ; wt=wt->nextThrottle)  
      if (wt->clientid==clientId) {
       DIAG(F("Withrottle client %d dropped"),clientId);
+      MEMORY_SCOPE(NETWORK);
       delete wt;
       break; 
      }
@@ -205,7 +208,10 @@ void WiThrottle::parse(RingStream * stream, byte * cmdx) {
 	}
       }
       if (Diag::WITHROTTLE) DIAG(F("WiThrottle(%d) Quit"),clientid);
-      delete this; 
+      {
+        MEMORY_SCOPE(NETWORK);
+        delete this; 
+      }
       break;           
     }
     // skip over cmd until 0 or past \r or \n
@@ -397,6 +403,7 @@ void WiThrottle::checkHeartbeat(RingStream * stream) {
       }
     }
     // if it does come back, the throttle should re-acquire 
+    MEMORY_SCOPE(NETWORK);
     delete this;
     return;
   }
@@ -30,6 +30,7 @@
 #include "RingStream.h"
 #include "CommandDistributor.h"
 #include "WiThrottle.h"
+#include "MemoryStats.h"
 /*
 #include "soc/rtc_wdt.h"
 #include "esp_task_wdt.h"
@@ -120,6 +121,7 @@ bool WifiESP::setup(const char *SSid,
                     int port,
                     const byte channel,
                     const bool forceAP) {
+  MEMORY_SCOPE(NETWORK);
   bool havePassword = true;
   bool haveSSID = true;
   bool wifiUp = false;
@@ -289,6 +291,9 @@ void WifiESP::loop() {
       }
     }
     if (server->hasClient()) {
+#ifndef WIFI_TASK_ON_CORE0  // Scopes only work in the main loop
+      MEMORY_SCOPE(NETWORK);
+#endif
       WiFiClient client;
       while (client = server->available()) {
 	for (clientId=0; clientId<clients.size(); clientId++){
@@ -28,6 +28,7 @@
 #include "StringFormatter.h"
 
 #include "WifiInboundHandler.h"
+#include "MemoryStats.h"
 
 
 
@@ -93,6 +94,7 @@ bool WifiInterface::setup(long serial_link_speed,
                           const int port,
                           const byte channel,
                           const bool forceAP) {
+  MEMORY_SCOPE(NETWORK);
 
   wifiSerialState wifiUp = WIFI_NOAT;
 
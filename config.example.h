@@ -183,6 +183,61 @@ The configuration file for DCC-EX Command Station
 //
 // #define DISABLE_EEPROM
 
+/////////////////////////////////////////////////////////////////////////////////////
+// SAVE LOCO STATES
+//
+// If defined, the direction and functions of each loco in the reminder table
+// are saved in the EEPROM (a few seconds after they change), and the locos are 
+// restored, with speed 0, when the command station restarts.  The decoders then
+// get their function states as soon as the DCC signal starts, and throttles 
+// can pick up where they left off.  Not available if the EEPROM is disabled.
+//
+// #define SAVE_LOCO_STATES
+
+/////////////////////////////////////////////////////////////////////////////////////
+// STATIC MEMORY POOLS
+//
+// If defined, turnouts, sensors, outputs, PCA9685 servo data, notification 
+// callbacks, EXRAIL lookup lists and stream buffers are placed in memory that is 
+// reserved when the program is compiled, instead of being allocated from the heap 
+// as they are created.  The memory they use is then included in the RAM figure 
+// shown by the compiler, and the heap doesn't get fragmented.  The sizes of the 
+// pools may be set below (numbers of objects, or bytes for the lists and buffers);
+// if not, defaults are used.  The command <D POOLS> shows how much of each pool 
+// has been used.  If a pool is full, further objects are allocated from the heap 
+// as usual (except sensors, which can't then be created).
+//
+// #define STATIC_MEMORY_POOLS
+// #define TURNOUT_POOL_SIZE 32
+// #define SENSOR_POOL_SIZE 32
+// #define OUTPUT_POOL_SIZE 16
+// #define SERVO_POOL_SIZE 32
+// #define CALLBACK_POOL_SIZE 4
+// #define LOOKLIST_POOL_SIZE 512
+// #define RINGSTREAM_POOL_SIZE 2560
+
+/////////////////////////////////////////////////////////////////////////////////////
+// MEMORY STATS
+//
+// If defined, the heap memory used by each part of the command station (HAL 
+// drivers, EXRAIL, network, and turnouts/sensors/outputs) is recorded, and can 
+// be listed with the command <D MEM>, together with the current and peak use, 
+// the largest free block and the lowest free memory seen.  Useful for finding 
+// out what is using the RAM on a fully loaded Mega.
+//
+// #define MEMORY_STATS
+
+/////////////////////////////////////////////////////////////////////////////////////
+// STM32 ADC SCAN GROUP
+//
+// On STM32F4 boards, the current sense inputs are normally read one at a time,
+// one input per waveform interrupt.  If this is defined, all the inputs in use
+// are converted by the ADC in one pass and the results collected by DMA (DMA2
+// stream 0), so each track's current is read more often when several tracks
+// are in use.  Don't define it if DMA2 stream 0 is used by something else.
+//
+// #define STM32_ADC_SCAN_GROUP
+
 /////////////////////////////////////////////////////////////////////////////////////
 // DISABLE PROG
 //
@@ -210,6 +210,48 @@
 #define WIFI_SERIAL_LINK_SPEED 115200
 #define WIFI_SERIAL_PORT Serial2
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// SAVE_LOCO_STATES: Loco directions and functions are saved in the EEPROM, 
+// so not possible if the EEPROM is disabled.
+//
+#if defined(SAVE_LOCO_STATES) && defined(DISABLE_EEPROM)
+  #undef SAVE_LOCO_STATES
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// STATIC_MEMORY_POOLS: Default pool sizes, if not set in config.h.
+//
+#ifdef STATIC_MEMORY_POOLS
+  #ifndef TURNOUT_POOL_SIZE
+    #define TURNOUT_POOL_SIZE 32
+  #endif
+  #ifndef SENSOR_POOL_SIZE
+    #define SENSOR_POOL_SIZE 32
+  #endif
+  #ifndef OUTPUT_POOL_SIZE
+    #define OUTPUT_POOL_SIZE 16
+  #endif
+  #ifndef SERVO_POOL_SIZE
+    #define SERVO_POOL_SIZE 32
+  #endif
+  #ifndef CALLBACK_POOL_SIZE
+    #define CALLBACK_POOL_SIZE 4
+  #endif
+  #ifndef LOOKLIST_POOL_SIZE
+    #define LOOKLIST_POOL_SIZE 512
+  #endif
+  #ifndef RINGSTREAM_POOL_SIZE
+    // Wifi or Ethernet buffers on AVR, or the ESP32 Wifi buffer.
+    #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+      #define RINGSTREAM_POOL_SIZE 2560
+    #else
+      #define RINGSTREAM_POOL_SIZE 10752
+    #endif
+  #endif
+#endif
+
 #if __has_include ( "myAutomation.h")
   #if defined(HAS_ENOUGH_MEMORY) || defined(DISABLE_EEPROM) || defined(DISABLE_PROG)
     #define EXRAIL_ACTIVE
@@ -0,0 +1,173 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host test of the STM32 scan group sequencing (ADCScanGroup.h), against mock
+ * ADC and DMA stream register blocks with the member names of the CMSIS
+ * ADC_TypeDef and DMA_Stream_TypeDef.  The DMA transfer is simulated by
+ * writing the results to the memory address given to the stream and clearing
+ * NDTR.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ADCScanGroup.h"
+
+struct MockADC {
+  volatile uint32_t SR, CR1, CR2, SQR1, SQR2, SQR3, DR;
+};
+
+struct MockDMAStream {
+  volatile uint32_t CR, NDTR;
+  volatile uintptr_t PAR, M0AR;  // Wide enough for host addresses
+};
+
+static const uint32_t ADC_SCAN = 1UL << 8;
+static const uint32_t ADC_OVR = 1UL << 5;
+static const uint32_t ADC_DMA = 1UL << 8;
+static const uint32_t DMA_EN = 1UL << 0;
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { printf("  FAILED line %d: %s\n", __LINE__, #condition); failures++; } \
+  } while (0)
+
+struct Fixture {
+  MockADC adc;
+  MockDMAStream dma;
+  volatile uint32_t flagClear;
+  ADCScanGroup<MockADC, MockDMAStream> group;
+  Fixture() : group(&adc, &dma, 0, &flagClear, 0x3DUL) {
+    memset((void *)&adc, 0, sizeof(adc));
+    memset((void *)&dma, 0, sizeof(dma));
+    flagClear = 0;
+  }
+  // Complete the DMA transfer of a pass, with 'base'+i as the ith result.
+  void completePass(uint16_t base) {
+    volatile uint16_t *results = (volatile uint16_t *)dma.M0AR;
+    for (uint32_t i = 0; i < dma.NDTR; i++) results[i] = base + i;
+    dma.NDTR = 0;
+  }
+};
+
+// The channels of the sequence are packed 5 bits each into SQR3 (1st to 6th),
+// SQR2 (7th to 12th) and SQR1 (13th to 16th), with the length - 1 in SQR1 L.
+static void testPacking(uint8_t count) {
+  printf("sequence of %d channels\n", count);
+  Fixture f;
+  uint32_t sqr[3] = {0, 0, 0};
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t channel = (i * 7 + 3) % 19;  // Mixed channel numbers, up to 18
+    CHECK(f.group.add(i, channel));
+    sqr[i / 6] |= (uint32_t)channel << ((i % 6) * 5);
+  }
+  CHECK(f.group.count() == count);
+  f.group.start();
+  CHECK(f.adc.SQR3 == sqr[0]);
+  CHECK(f.adc.SQR2 == sqr[1]);
+  CHECK((f.adc.SQR1 & 0xFFFFF) == sqr[2]);
+  CHECK(((f.adc.SQR1 >> 20) & 0xF) == (uint32_t)(count - 1));
+  CHECK(f.adc.CR1 & ADC_SCAN);
+  CHECK(f.adc.CR2 & ADC_DMA);
+  CHECK(f.dma.CR & DMA_EN);
+  CHECK(f.dma.NDTR == count);
+  CHECK(f.dma.PAR == (uintptr_t)&f.adc.DR);
+  CHECK(f.flagClear == 0x3DUL);
+}
+
+static void testAddReplaces() {
+  printf("add() replaces an existing id\n");
+  Fixture f;
+  CHECK(f.group.add(5, 3));
+  CHECK(f.group.add(7, 4));
+  CHECK(f.group.add(5, 9));
+  CHECK(f.group.count() == 2);
+  f.group.start();
+  CHECK(f.adc.SQR3 == (9UL | (4UL << 5)));
+  // The sequence is full at 16 channels.
+  Fixture g;
+  for (uint8_t i = 0; i < 16; i++) CHECK(g.group.add(i, i));
+  CHECK(!g.group.add(16, 0));
+  CHECK(g.group.add(15, 1));  // Replacing is still allowed
+}
+
+static void testPoll() {
+  printf("poll() copies complete passes by id\n");
+  Fixture f;
+  f.group.add(2, 10);
+  f.group.add(0, 11);
+  f.group.add(5, 12);
+  f.group.start();
+  int values[6] = {-1, -1, -1, -1, -1, -1};
+  CHECK(!f.group.poll(values));  // Pass in progress
+  CHECK(values[2] == -1);
+  f.completePass(100);
+  CHECK(f.group.poll(values));
+  CHECK(values[2] == 100 && values[0] == 101 && values[5] == 102);
+  CHECK(values[1] == -1);
+  CHECK(f.dma.NDTR == 3);  // Next pass started
+}
+
+static void testOverrun() {
+  printf("poll() discards a pass with an overrun\n");
+  Fixture f;
+  f.group.add(0, 1);
+  f.group.add(1, 2);
+  f.group.start();
+  int values[2] = {-1, -1};
+  f.completePass(200);
+  f.adc.SR |= ADC_OVR;
+  CHECK(!f.group.poll(values));
+  CHECK(values[0] == -1 && values[1] == -1);
+  CHECK(!(f.adc.SR & ADC_OVR));
+  CHECK(f.dma.NDTR == 2);  // Pass restarted
+  f.completePass(300);
+  CHECK(f.group.poll(values));
+  CHECK(values[0] == 300 && values[1] == 301);
+}
+
+static void testStop() {
+  printf("stop() returns the ADC to single conversions\n");
+  Fixture f;
+  for (uint8_t i = 0; i < 8; i++) f.group.add(i, i);
+  f.group.start();
+  f.completePass(0);
+  f.group.stop();
+  CHECK(f.adc.SQR1 == 0);
+  CHECK(!(f.adc.CR1 & ADC_SCAN));
+  CHECK(!(f.adc.CR2 & ADC_DMA));
+  CHECK(!(f.dma.CR & DMA_EN));
+  int values[8];
+  CHECK(!f.group.poll(values));  // Not running
+}
+
+int main() {
+  testPacking(1);
+  testPacking(6);
+  testPacking(7);
+  testPacking(16);
+  testAddReplaces();
+  testPoll();
+  testOverrun();
+  testStop();
+  if (failures) printf("%d FAILED\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host check and microbenchmark of the EX-IOExpander analogue pin lookup
+ * (AnalogueSlotMap.h), over a 16-channel expander laid out like a Mega: 46
+ * digital pins, then the analogue pins A0-A15 as pins 46-61.
+ *
+ * Every pin of the device is read through the slot map and through the linear
+ * search of the pin map that _readAnalogue used before, and the results must
+ * agree.  Then the time per lookup of each is printed; the times are not
+ * checked, as they depend on the host.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "AnalogueSlotMap.h"
+
+static const uint8_t NUM_DIGITAL = 46;
+static const uint8_t NUM_ANALOGUE = 16;
+static const uint8_t NUM_PINS = NUM_DIGITAL + NUM_ANALOGUE;
+static const long ITERATIONS = 2000000L;
+
+static uint8_t pinMap[NUM_ANALOGUE];
+static uint8_t analogueInputStates[NUM_ANALOGUE * 2];
+
+static int failures = 0;
+
+// _readAnalogue before the slot map.
+static int readLinear(unsigned int pin) {
+  for (uint8_t aPin = 0; aPin < NUM_ANALOGUE; aPin++) {
+    if (pinMap[aPin] == pin) {
+      uint8_t _pinLSBByte = aPin * 2;
+      uint8_t _pinMSBByte = _pinLSBByte + 1;
+      return (analogueInputStates[_pinMSBByte] << 8) + analogueInputStates[_pinLSBByte];
+    }
+  }
+  return -1;  // pin not found in table
+}
+
+// _readAnalogue with the slot map.
+static int readMapped(const AnalogueSlotMap &map, unsigned int pin) {
+  uint8_t aPin = map.slot(pin);
+  if (aPin >= NUM_ANALOGUE) return -1;  // pin not found in table
+  uint8_t _pinLSBByte = aPin * 2;
+  uint8_t _pinMSBByte = _pinLSBByte + 1;
+  return (analogueInputStates[_pinMSBByte] << 8) + analogueInputStates[_pinLSBByte];
+}
+
+static double nsPerLookup(clock_t start, clock_t end) {
+  return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / ((double)ITERATIONS * NUM_ANALOGUE);
+}
+
+int main() {
+  // The expander reports its analogue pins in any order; use a shuffled one.
+  for (uint8_t aPin = 0; aPin < NUM_ANALOGUE; aPin++) {
+    pinMap[aPin] = NUM_DIGITAL + (aPin * 5) % NUM_ANALOGUE;
+    int value = 1023 - aPin * 61;
+    analogueInputStates[aPin * 2] = value & 0xFF;
+    analogueInputStates[aPin * 2 + 1] = value >> 8;
+  }
+  AnalogueSlotMap map;
+  if (!map.build(pinMap, NUM_ANALOGUE)) {
+    printf("build failed\n");
+    return 1;
+  }
+
+  // Every pin, including digital pins and pins beyond the device.
+  for (unsigned int pin = 0; pin < NUM_PINS + 10; pin++) {
+    int expected = readLinear(pin);
+    int actual = readMapped(map, pin);
+    if (actual != expected) {
+      printf("pin %u: slot map gives %d, pin map %d\n  FAILED\n", pin, actual, expected);
+      failures++;
+    }
+  }
+  // A smaller pin map reuses the table, and drops the pins no longer listed.
+  if (!map.build(pinMap, 4) || map.slot(pinMap[4]) != AnalogueSlotMap::NONE || map.slot(pinMap[3]) != 3) {
+    printf("rebuild with fewer pins\n  FAILED\n");
+    failures++;
+  }
+  map.build(pinMap, NUM_ANALOGUE);
+  printf("%d analogue pins of %d checked\n", NUM_ANALOGUE, NUM_PINS);
+
+  // Time reads of all the analogue pins.  The sum stops the reads being
+  // optimised away.
+  volatile long sink = 0;
+  long sum = 0;
+  clock_t start = clock();
+  for (long i = 0; i < ITERATIONS; i++)
+    for (uint8_t aPin = 0; aPin < NUM_ANALOGUE; aPin++)
+      sum += readLinear(NUM_DIGITAL + aPin);
+  clock_t end = clock();
+  sink = sink + sum;
+  printf("linear search of pin map %6.2f ns/read\n", nsPerLookup(start, end));
+
+  sum = 0;
+  start = clock();
+  for (long i = 0; i < ITERATIONS; i++)
+    for (uint8_t aPin = 0; aPin < NUM_ANALOGUE; aPin++)
+      sum += readMapped(map, NUM_DIGITAL + aPin);
+  end = clock();
+  sink = sink + sum;
+  printf("slot map                 %6.2f ns/read\n", nsPerLookup(start, end));
+
+  if (failures) printf("%d FAILED\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/*
+ *  © 2026 agent
+ *  All rights reserved.
+ *
+ *  This file is part of CommandStation-EX
+ *
+ *  This is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  It is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with CommandStation.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host test of the overload trip curve (OverloadFilter.h).
+ *
+ * Current traces are replayed through the filter, with the ALERT handling of
+ * MotorDriver::checkPowerOverload (the time over the trip current is counted
+ * from the first filtered reading over it, and cleared after 20ms of good
+ * readings), and the time to trip is checked.
+ *
+ * With no arguments, the built-in traces are run and checked.  Otherwise each
+ * argument is a trace file to replay, with one reading per line as
+ * "elapsedMicros current", and "# trip N max M" lines giving the trip current
+ * and highest ADC reading; the trip time, if any, is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "OverloadFilter.h"
+
+static const unsigned long ALERT_GOOD_MICROS = 20000UL;  // MotorDriver::POWER_SAMPLE_ALERT_GOOD
+static const unsigned long SAMPLE_MICROS = 500;
+static const int ADC_MAX = 4095;
+
+// Replays readings one at a time, as checkPowerOverload does.
+class Replay {
+public:
+  Replay(OverloadFilter &filter, int tripValue, int maxReading)
+    : _filter(filter), _tripValue(tripValue), _maxReading(maxReading) {
+    _filter.reset();
+  }
+  // Returns true if the track trips on this reading.
+  bool reading(int current, unsigned long elapsedMicros) {
+    _now += elapsedMicros;
+    if (_tripped) return true;
+    int filtered = _filter.sample(current < 0 ? -current : current, elapsedMicros, _tripValue);
+    bool over = filtered >= _tripValue;
+    if (!_alert) {
+      if (!over) return false;
+      _alert = true;
+      _alertStart = _now;
+      _lastBad = _now;
+    }
+    if (over) {
+      _lastBad = _now;
+      if (_filter.tripped(filtered, _tripValue, _maxReading, _now - _alertStart)) {
+        _tripped = true;
+        _tripTime = _now;
+      }
+    } else if (_now - _lastBad > ALERT_GOOD_MICROS) {
+      _alert = false;
+    }
+    return _tripped;
+  }
+  bool tripped() { return _tripped; }
+  unsigned long tripMicros() { return _tripTime; }
+  unsigned long now() { return _now; }
+
+private:
+  OverloadFilter &_filter;
+  int _tripValue, _maxReading;
+  unsigned long _now = 0, _alertStart = 0, _lastBad = 0, _tripTime = 0;
+  bool _alert = false, _tripped = false;
+};
+
+static int failures = 0;
+
+// Deterministic noise in the range -amplitude to +amplitude.
+static int noise(int amplitude) {
+  static uint32_t seed = 12345;
+  seed = seed * 1103515245UL + 12345UL;
+  return (int)((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+// Run 'normal' for 200ms, then 'overload' (with noise) for up to 'runMs', and
+// check that the trip comes between minMs and maxMs after the overload
+// starts, or not at all if maxMs is 0.
+static void check(const char *name, OverloadFilter &filter, int tripValue, int normal,
+    int overload, int noiseAmplitude, unsigned long runMs, unsigned long minMs, unsigned long maxMs,
+    int maxReading = ADC_MAX) {
+  Replay replay(filter, tripValue, maxReading);
+  for (unsigned long t = 0; t < 200000UL; t += SAMPLE_MICROS)
+    replay.reading(normal + noise(noiseAmplitude), SAMPLE_MICROS);
+  unsigned long start = replay.now();
+  while (replay.now() - start < runMs * 1000UL && !replay.tripped()) {
+    int current = overload + noise(noiseAmplitude);
+    if (current > maxReading) current = maxReading;  // ADC saturates
+    replay.reading(current, SAMPLE_MICROS);
+  }
+  bool ok;
+  if (maxMs == 0) {
+    ok = !replay.tripped();
+    printf("%-40s %s\n", name, replay.tripped() ? "tripped" : "no trip");
+  } else {
+    unsigned long ms = (replay.tripMicros() - start) / 1000;
+    ok = replay.tripped() && ms >= minMs && ms <= maxMs;
+    if (replay.tripped())
+      printf("%-40s trip after %lums (expected %lu-%lums)\n", name, ms, minMs, maxMs);
+    else
+      printf("%-40s no trip (expected %lu-%lums)\n", name, minMs, maxMs);
+  }
+  if (!ok) {
+    printf("  FAILED\n");
+    failures++;
+  }
+}
+
+// A short spike, e.g. inrush when a loco is put on the track.
+static void checkSpike(const char *name, OverloadFilter &filter, int tripValue, int spike, unsigned long spikeMicros) {
+  Replay replay(filter, tripValue, ADC_MAX);
+  for (unsigned long t = 0; t < 200000UL; t += SAMPLE_MICROS)
+    replay.reading(tripValue / 2, SAMPLE_MICROS);
+  for (unsigned long t = 0; t < spikeMicros; t += SAMPLE_MICROS)
+    replay.reading(spike, SAMPLE_MICROS);
+  for (unsigned long t = 0; t < 500000UL; t += SAMPLE_MICROS)
+    replay.reading(tripValue / 2, SAMPLE_MICROS);
+  printf("%-40s %s\n", name, replay.tripped() ? "tripped" : "no trip");
+  if (replay.tripped()) {
+    printf("  FAILED\n");
+    failures++;
+  }
+}
+
+static void runBuiltIn() {
+  OverloadFilter filter;
+  const int trip = 1000;
+  // Normal running and noise must not trip.
+  check("steady 0.8x", filter, trip, 800, 800, 0, 2000, 0, 0);
+  check("noisy 0.8x +-0.2x", filter, trip, 800, 800, 200, 2000, 0, 0);
+  checkSpike("3x spike for 1ms", filter, trip, 3000, 1000);
+  checkSpike("noise sample at ADC max", filter, trip, ADC_MAX, SAMPLE_MICROS);
+  // No overload lasts longer than the curve time (100ms), counted from when
+  // the filtered current reaches the trip current, a few readings after the
+  // overload starts.
+  check("1.2x", filter, trip, 500, 1200, 0, 2000, 95, 104);
+  check("1.2x noisy", filter, trip, 500, 1200, 100, 2000, 90, 104);
+  check("2x", filter, trip, 500, 2000, 0, 2000, 90, 104);
+  // Larger overloads trip sooner: 3x has excess 8 against 3 at 2x.
+  check("3x", filter, trip, 500, 3000, 0, 2000, 30, 45);
+  // Above the hard limit (400%) the trip is immediate.
+  check("5x hard limit", filter, trip, 500, 5000, 0, 2000, 0, 3, 8191);
+  // A hard limit the ADC can't reach is capped below saturation.
+  check("saturated ADC, trip 0.5 max", filter, ADC_MAX / 2, 500, ADC_MAX + 1000, 0, 2000, 0, 8);
+  // Programming track: much lower trip value, same timing.
+  check("prog 1.2x", filter, 60, 20, 72, 0, 2000, 95, 104);
+
+  // A longer curve.
+  if (!filter.setCurve(1000, 400, 2)) {
+    printf("setCurve(1000, 400, 2) rejected\n  FAILED\n");
+    failures++;
+  }
+  check("curve 1000ms, 1.2x", filter, trip, 500, 1200, 0, 3000, 990, 1004);
+  check("curve 1000ms, 2x", filter, trip, 500, 2000, 0, 3000, 950, 1004);
+  check("curve 1000ms, 3x", filter, trip, 500, 3000, 0, 3000, 330, 420);
+
+  // Parameter checks.
+  const struct { uint16_t curveMs, hardPercent; uint8_t filterShift; bool ok; } params[] = {
+    {0, 400, 2, false}, {10001, 400, 2, false}, {100, 100, 2, false}, {100, 400, 9, false},
+    {1, 101, 0, true}, {10000, 1000, 8, true},
+  };
+  for (auto &p : params) {
+    if (filter.setCurve(p.curveMs, p.hardPercent, p.filterShift) != p.ok) {
+      printf("setCurve(%u, %u, %u) should %s\n  FAILED\n", p.curveMs, p.hardPercent, p.filterShift,
+        p.ok ? "succeed" : "fail");
+      failures++;
+    }
+  }
+}
+
+// Replay a trace file and print the trip time.
+static void runFile(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    printf("%s: can't open\n", path);
+    failures++;
+    return;
+  }
+  int tripValue = 0, maxReading = ADC_MAX;
+  char line[100];
+  OverloadFilter filter;
+  Replay *replay = NULL;
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#') {
+      sscanf(line, "# trip %d max %d", &tripValue, &maxReading);
+      continue;
+    }
+    unsigned long elapsed;
+    int current;
+    if (sscanf(line, "%lu %d", &elapsed, &current) != 2) continue;
+    if (!replay) replay = new Replay(filter, tripValue, maxReading);
+    if (replay->reading(current, elapsed)) break;
+  }
+  fclose(f);
+  if (replay && replay->tripped())
+    printf("%s: trip at %luus\n", path, replay->tripMicros());
+  else
+    printf("%s: no trip\n", path);
+  delete replay;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2)
+    runBuiltIn();
+  for (int i = 1; i < argc; i++)
+    runFile(argv[i]);
+  if (failures) printf("%d FAILED\n", failures);
+  return failures ? 1 : 0;
+}
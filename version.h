@@ -3,7 +3,33 @@
 
 #include "StringFormatter.h"
 
-#define VERSION "5.0.9"
+#define VERSION "5.0.34"
+// 5.0.34 - DCC signal pins of MAIN and PROG tracks set with one write per port
+// 5.0.33 - TrackManager keeps the tracks partitioned by mode for the ISR and power functions
+// 5.0.32 - Ack current samples tagged by waveform phase, <D ACK PHASE mask>
+// 5.0.31 - STM32: optional scan group ADC sampling with DMA (STM32_ADC_SCAN_GROUP)
+// 5.0.30 - Overload detection with filtered current and I squared t trip curve, <D TRIP>
+// 5.0.29 - <D CURRENT track window interval> streams min/max/mean track current per window as <jS> frames
+// 5.0.28 - Displays on an I2C mux sub-bus are updated as a group, and the I2C manager doesn't reselect a sub-bus that is still selected
+// 5.0.27 - Changed display rows are shown within half a second, with bursts of changes to a row coalesced into one screen update
+// 5.0.26 - OLED display sends up to five characters per I2C transmission
+// 5.0.25 - Display refresh only sends the characters that have changed
+// 5.0.24 - Build option MEMORY_STATS: heap use per subsystem (HAL, EXRAIL, network, objects) with peaks, <D MEM> lists them with largest free block
+// 5.0.23 - Build option STATIC_MEMORY_POOLS: turnouts, sensors, outputs, servo data, callbacks, EXRAIL lists and stream buffers in fixed pools, <D POOLS> reports use
+// 5.0.22 - Optional SAVE_LOCO_STATES: loco directions and functions saved in EEPROM and restored at startup
+// 5.0.21 - EEPROM definitions read in one block at startup, tables pre-sized, load time reported
+// 5.0.20 - EEPROM format DCC++2: CRC-checked definitions, turnout/output states in a journal, <E> writes only changed bytes
+// 5.0.19 - Turnout and output state changes written to EEPROM in the background, <D EEPROM> shows counts
+// 5.0.18 - Turnout, Sensor and Output lookup by id through a sorted index (IdIndex)
+// 5.0.17 - Sensor debounce is time based, per sensor, set by <S id vpin pullup ms> or EXRAIL SENSOR_DEBOUNCE(id,ms)
+// 5.0.16 - Sensors: compact table of parallel arrays instead of linked list of objects
+// 5.0.15 - Sensors: pending-change queue for notified sensors, poll only sensors that need it
+// 5.0.14 - Sensors: VPIN-sorted index for change notification dispatch
+// 5.0.13 - HAL: port-level batched input change notification
+// 5.0.12 - HAL: analogue threshold watches (IOAnalogueWatch) with hysteresis
+//        - EXRAIL ATGTE/ATLT woken by analogue watches instead of polling
+// 5.0.11 - EX-IOExpander: direct-indexed analogue pin lookup
+// 5.0.10 - EX-IOExpander: notify digital input changes to subscribers instead of polling
 // 5.0.9  - EX-IOExpander bug fix for memory allocation
 //        - EX-IOExpander bug fix to allow for devices with no analogue or no digital pins
 // 5.0.8  - Bugfix: Do not crash on turnouts without description